@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""
+## RESUMO ##
+
+Benchmark reproduzível dos três cenários (trabalho.cc, power-adaptation-distance.cc e
+wifi-simple-interference.cc).
+
+Cada configuração é fixa e usa sempre o mesmo RngRun. Ela é executada 'repeat' vezes
+com --profileFile (profiler.h), e o benchmark registra por execução:
+> wall: soma dos tempos de parede das fases medidas pelo próprio programa [s]
+> processWall: tempo de parede do processo, incluindo o waf [s]
+> events e eventsPerSecond: eventos executados pelo simulador
+> allocations: chamadas ao operator new (todas as formas)
+> processPeakRssKb: pico de memória residente do processo ao fim do último perfil
+O resultado (amostras, mediana, mínimo e desvio padrão de cada métrica) é gravado em
+JSON. Com --baseline, as medianas são comparadas com as de um resultado anterior e o
+programa termina com código 1 se alguma métrica piorar mais que o orçamento (--budget).
+O número de eventos é determinístico: uma diferença indica que o comportamento da
+simulação mudou, e não apenas o desempenho.
+A contagem de alocações exige que o ns-3 seja configurado com
+CXXFLAGS="-DPROFILER_COUNT_ALLOCATIONS" (profiler.h); sem ela, o benchmark termina com
+erro na primeira execução em vez de gravar um resultado sem alocações.
+
+Uso (na raiz do ns-3, com os programas em scratch/):
+  CXXFLAGS="-DPROFILER_COUNT_ALLOCATIONS" ./waf configure
+  ./scratch/benchmark.py --output=benchmark.json
+  ./scratch/benchmark.py --output=new.json --baseline=benchmark.json --budget=0.05
+  ./scratch/benchmark.py --list
+  ./scratch/benchmark.py --only=trabalho-udp-mcs0,interference-1000
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+# Métricas comparadas com o baseline: nome -> True se valores maiores são melhores
+METRICS = {
+    "wall": False,
+    "processWall": False,
+    "eventsPerSecond": True,
+    "allocations": False,
+    "processPeakRssKb": False,
+}
+
+
+def survey_points(count):
+    """Pontos do levantamento de power-adaptation-distance: uma linha a partir do AP."""
+    return "".join("%g %g\n" % (1.0 + 0.5 * i, 1.0) for i in range(count))
+
+
+def build_configs():
+    """Configurações fixas do benchmark: nome -> (programa, argumentos, arquivos de entrada)."""
+    configs = {}
+    for protocol, udp in (("udp", 1), ("tcp", 0)):
+        for mcs in (0, 11):
+            configs["trabalho-%s-mcs%d" % (protocol, mcs)] = (
+                "trabalho",
+                ["--udp=%d" % udp, "--mcs=%d" % mcs, "--simulationTime=1", "--workers=1"],
+                {})
+    for count in (1, 10, 100):
+        configs["power-survey-%d" % count] = (
+            "power-adaptation-distance",
+            ["--surveyFile=survey.txt", "--stepsTime=1"],
+            {"survey.txt": survey_points(count)})
+    for packets in (100, 1000, 10000):
+        configs["interference-%d" % packets] = (
+            "wifi-simple-interference",
+            ["--numPackets=%d" % packets, "--interval=0.001", "--pcap=0"],
+            {})
+    return configs
+
+
+def run_once(waf, program, args, inputs, run):
+    """Executa o programa uma vez em um diretório temporário e resume os perfis gravados."""
+    with tempfile.TemporaryDirectory(prefix="benchmark-") as cwd:
+        for name, content in inputs.items():
+            with open(os.path.join(cwd, name), "w") as f:
+                f.write(content)
+        profile = os.path.join(cwd, "profile.json")
+        command = " ".join(["scratch/" + program] + args +
+                           ["--RngRun=%d" % run, "--profileFile=" + profile])
+        start = time.monotonic()
+        result = subprocess.run([waf, "--run", command, "--cwd=" + cwd],
+                                stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                                universal_newlines=True)
+        processWall = time.monotonic() - start
+        if result.returncode != 0:
+            sys.exit("%s falhou (código %d):\n%s" % (command, result.returncode, result.stderr))
+        with open(profile) as f:
+            profiles = [json.loads(line) for line in f if line.strip()]
+
+    if any(p.get("allocations") is None for p in profiles):
+        sys.exit("%s não contou as alocações: configure o ns-3 com "
+                 "CXXFLAGS=\"-DPROFILER_COUNT_ALLOCATIONS\" ./waf configure" % command)
+
+    wall = sum(phase["seconds"] for p in profiles for phase in p["phases"])
+    eventSeconds = sum(phase["seconds"] for p in profiles for phase in p["phases"] if phase["events"] > 0)
+    events = sum(p["events"] for p in profiles)
+    return {
+        "wall": wall,
+        "processWall": processWall,
+        "events": events,
+        "eventsPerSecond": events / eventSeconds if eventSeconds > 0 else 0,
+        "allocations": sum(p["allocations"] for p in profiles),
+        "processPeakRssKb": max(p["processPeakRssKb"] for p in profiles),
+    }
+
+
+def summarize(samples):
+    summary = {}
+    for metric in list(METRICS) + ["events"]:
+        values = [s[metric] for s in samples]
+        summary[metric] = {
+            "median": statistics.median(values),
+            "min": min(values),
+            "stdev": statistics.stdev(values) if len(values) > 1 else 0,
+        }
+    return summary
+
+
+def compare(results, baseline, budget):
+    """Imprime a comparação com o baseline e retorna a quantidade de regressões."""
+    regressions = 0
+    for name, current in sorted(results["configs"].items()):
+        reference = baseline["configs"].get(name)
+        if reference is None:
+            print("%-28s sem baseline" % name)
+            continue
+        if current["summary"]["events"]["median"] != reference["summary"]["events"]["median"]:
+            print("%-28s eventos mudaram: %d -> %d (o comportamento da simulação mudou)"
+                  % (name, reference["summary"]["events"]["median"], current["summary"]["events"]["median"]))
+        for metric, higherIsBetter in METRICS.items():
+            if reference["summary"].get(metric) is None:
+                print("%-28s %-16s sem baseline" % (name, metric))
+                continue
+            old = reference["summary"][metric]["median"]
+            new = current["summary"][metric]["median"]
+            if old == 0:
+                continue
+            change = (new - old) / old
+            worse = -change if higherIsBetter else change
+            status = "REGRESSÃO" if worse > budget else "ok"
+            regressions += worse > budget
+            print("%-28s %-16s %14.6g -> %14.6g  %+7.2f%%  %s" % (name, metric, old, new, 100 * change, status))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Reproducible benchmark of the three ns-3 scenarios")
+    parser.add_argument("--waf", default="./waf", help="waf script of the ns-3 tree (run from its root)")
+    parser.add_argument("--repeat", type=int, default=5, help="runs of each configuration")
+    parser.add_argument("--run", type=int, default=1, help="RngRun used by every run")
+    parser.add_argument("--only", default="", help="comma-separated configurations to run (default: all)")
+    parser.add_argument("--list", action="store_true", help="list the configurations and exit")
+    parser.add_argument("--output", default="benchmark.json", help="JSON file receiving the results")
+    parser.add_argument("--baseline", default="", help="previous results to compare against")
+    parser.add_argument("--budget", type=float, default=0.10,
+                        help="largest accepted relative regression of a median before failing")
+    options = parser.parse_args()
+
+    configs = build_configs()
+    if options.list:
+        for name, (program, args, _) in sorted(configs.items()):
+            print("%-28s %s %s" % (name, program, " ".join(args)))
+        return 0
+    names = sorted(configs) if not options.only else options.only.split(",")
+    for name in names:
+        if name not in configs:
+            sys.exit("configuração desconhecida: %s" % name)
+
+    # Compila uma única vez, para que a compilação não entre nas medições
+    subprocess.run([options.waf, "build"], check=True, stdout=subprocess.DEVNULL)
+
+    results = {"version": 1, "repeat": options.repeat, "run": options.run, "configs": {}}
+    for name in names:
+        program, args, inputs = configs[name]
+        samples = []
+        for i in range(options.repeat):
+            samples.append(run_once(options.waf, program, args, inputs, options.run))
+            print("%-28s %d/%d  %.3f s  %d events  %d allocations  %d kB"
+                  % (name, i + 1, options.repeat, samples[-1]["wall"], samples[-1]["events"],
+                     samples[-1]["allocations"], samples[-1]["processPeakRssKb"]), flush=True)
+        results["configs"][name] = {
+            "program": program,
+            "args": args,
+            "samples": samples,
+            "summary": summarize(samples),
+        }
+
+    with open(options.output, "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+    print("Resultados gravados em %s" % options.output)
+
+    if options.baseline:
+        with open(options.baseline) as f:
+            baseline = json.load(f)
+        regressions = compare(results, baseline, options.budget)
+        if regressions > 0:
+            print("%d métrica(s) acima do orçamento de %.1f%%" % (regressions, 100 * options.budget))
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
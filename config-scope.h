@@ -0,0 +1,86 @@
+/*
+## RESUMO ##
+
+Contexto de configuração com escopo, usado por trabalho.cc.
+
+> ConfigScope: altera valores padrão de atributos ("ns3::Tipo::Atributo", como em
+Config::SetDefault) apenas enquanto o objeto existir. Antes da primeira alteração de
+cada atributo, o valor padrão em vigor é guardado; o destrutor restaura os valores
+guardados na ordem inversa. Assim, um padrão de um ponto da varredura vale apenas para
+os objetos criados durante a simulação desse ponto e não vaza para o ponto seguinte
+simulado no mesmo processo.
+Deve ser usado apenas para atributos sem caminho por objeto (em trabalho.cc, o tamanho
+do segmento TCP, lido pelos sockets que as aplicações criam ao iniciar). Os demais
+devem ser passados aos helpers que criam os objetos ou alterados diretamente nesses
+objetos, e não por caminhos como "/NodeList/...", que alcançam todos os nós do processo.
+*/
+
+#ifndef CONFIG_SCOPE_H
+#define CONFIG_SCOPE_H
+
+#include "ns3/config.h"
+#include "ns3/type-id.h"
+#include "ns3/log.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class ConfigScope
+{
+public:
+  ConfigScope ();
+  ~ConfigScope ();
+
+  void SetDefault (const std::string &name, const AttributeValue &value);
+
+private:
+  // Não copiável: cada escopo restaura os seus próprios valores uma única vez
+  ConfigScope (const ConfigScope &);
+  ConfigScope &operator= (const ConfigScope &);
+
+  std::vector<std::pair<std::string, Ptr<AttributeValue> > > m_previous; // valores a restaurar
+};
+
+inline
+ConfigScope::ConfigScope ()
+{
+}
+
+inline
+ConfigScope::~ConfigScope ()
+{
+  for (std::size_t i = m_previous.size (); i-- > 0; )
+    {
+      Config::SetDefault (m_previous[i].first, *m_previous[i].second);
+    }
+}
+
+// Altera o valor padrão 'name' ("ns3::Tipo::Atributo") até o fim do escopo
+inline void
+ConfigScope::SetDefault (const std::string &name, const AttributeValue &value)
+{
+  bool saved = false;
+  for (std::size_t i = 0; i < m_previous.size () && !saved; i++)
+    {
+      saved = m_previous[i].first == name;
+    }
+  if (!saved)
+    {
+      std::string::size_type separator = name.rfind ("::");
+      TypeId tid;
+      TypeId::AttributeInformation info;
+      if (separator == std::string::npos || !TypeId::LookupByNameFailSafe (name.substr (0, separator), &tid)
+          || !tid.LookupAttributeByName (name.substr (separator + 2), &info))
+        {
+          NS_FATAL_ERROR ("Unknown attribute " << name);
+        }
+      m_previous.push_back (std::make_pair (name, info.initialValue->Copy ()));
+    }
+  Config::SetDefault (name, value);
+}
+
+} // namespace ns3
+
+#endif /* CONFIG_SCOPE_H */
@@ -0,0 +1,488 @@
+/*
+## RESUMO ##
+
+Canal Yans com índice espacial, usado por trabalho.cc e power-adaptation-distance.cc
+para simular levantamentos com muitos nós.
+
+O YansWifiChannel agenda a recepção de cada quadro em todas as PHYs do canal, mesmo
+nas que estão muito abaixo do limiar de detecção, de modo que o número de eventos
+cresce com o quadrado do número de nós. O IndexedYansWifiChannel mantém as PHYs em
+uma grade uniforme (células de "CellSize" metros no plano x-y) e, para cada quadro:
+> obtém o alcance máximo em que a potência recebida ainda pode chegar a
+"RxPowerFloor" (busca no próprio modelo de perda, uma vez por potência de tx);
+> percorre apenas as células dentro desse alcance (ou todas as PHYs, se a região
+cobrir mais células do que há PHYs);
+> agenda a recepção, em ordem de PHY, apenas quando a potência recebida (com o ganho
+de recepção) é maior ou igual a "RxPowerFloor".
+Sinais abaixo do piso não são somados à interferência, portanto o piso deve ficar
+bem abaixo do ruído térmico. O índice é atualizado de forma incremental pelo trace
+"CourseChange" dos modelos de mobilidade (por exemplo, a cada SetPosition das STAs).
+
+O alcance supõe um modelo de perda determinístico e decrescente com a distância
+(LogDistance, Friis, ...), o mesmo requisito do propagation-cache.h.
+
+Uso:
+  YansWifiPhyHelper phy = IndexedYansWifiPhyHelper::Default ();
+  phy.SetChannel (CreateIndexedChannel (channelHelper, rxPowerFloor));
+A IndexedYansWifiPhy só usa o índice quando ligada a um IndexedYansWifiChannel; com
+um YansWifiChannel comum ela se comporta como a YansWifiPhy.
+*/
+
+#ifndef INDEXED_YANS_CHANNEL_H
+#define INDEXED_YANS_CHANNEL_H
+
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-utils.h"
+#include "ns3/mobility-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "propagation-cache.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+class IndexedYansWifiPhy;
+
+class IndexedYansWifiChannel : public YansWifiChannel
+{
+public:
+  static TypeId GetTypeId (void);
+  IndexedYansWifiChannel ();
+
+  // Equivalente a YansWifiChannel::Send, restrito às PHYs ao alcance do transmissor
+  void SendIndexed (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration);
+
+  uint64_t GetScheduledReceptions (void) const;
+  uint64_t GetSkippedReceptions (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct IndexedPhy
+  {
+    Ptr<YansWifiPhy> phy;
+    Ptr<MobilityModel> mobility;
+    uint32_t node; // contexto da recepção agendada
+    uint64_t cell;
+  };
+
+  void Rebuild (void);
+  void Disconnect (void);
+  void UpdatePosition (Ptr<const MobilityModel> mobility);
+  uint64_t GetCell (const Vector &position) const;
+  void InsertCell (uint64_t cell, uint32_t index);
+  void RemoveCell (uint64_t cell, uint32_t index);
+  double GetRange (double txPowerDbm);
+  static void Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double rxPowerDbm, Time duration);
+
+  double m_rxPowerFloor; // potência mínima agendada [dBm]
+  double m_cellSize; // lado das células da grade [m]
+  Ptr<PropagationLossModel> m_loss;
+  Ptr<PropagationDelayModel> m_delay;
+  std::vector<IndexedPhy> m_phys; // mesma ordem das PHYs do YansWifiChannel
+  std::unordered_map<uint64_t, std::vector<uint32_t> > m_cells;
+  std::unordered_map<const MobilityModel *, std::vector<uint32_t> > m_physByMobility;
+  std::map<double, double> m_ranges; // alcance [m] por potência de transmissão [dBm]
+  double m_maxRxGain; // maior ganho de recepção entre as PHYs [dB]
+  Ptr<ConstantPositionMobilityModel> m_probeA; // posições usadas na busca do alcance
+  Ptr<ConstantPositionMobilityModel> m_probeB;
+  std::vector<uint32_t> m_candidates;
+  uint64_t m_scheduled;
+  uint64_t m_skipped;
+};
+
+// YansWifiPhy que entrega seus quadros ao IndexedYansWifiChannel
+class IndexedYansWifiPhy : public YansWifiPhy
+{
+public:
+  static TypeId GetTypeId (void);
+  IndexedYansWifiPhy ();
+
+  virtual void StartTx (Ptr<Packet> packet, WifiTxVector txVector, Time txDuration);
+};
+
+// YansWifiPhyHelper que cria IndexedYansWifiPhy no lugar de YansWifiPhy
+class IndexedYansWifiPhyHelper : public YansWifiPhyHelper
+{
+public:
+  IndexedYansWifiPhyHelper ();
+  static IndexedYansWifiPhyHelper Default (void);
+};
+
+NS_OBJECT_ENSURE_REGISTERED (IndexedYansWifiChannel);
+
+inline TypeId
+IndexedYansWifiChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IndexedYansWifiChannel")
+    .SetParent<YansWifiChannel> ()
+    .AddConstructor<IndexedYansWifiChannel> ()
+    .AddAttribute ("RxPowerFloor",
+                   "Receptions whose power (including the receiver gain) is below this value are not scheduled (dBm).",
+                   DoubleValue (-110.0),
+                   MakeDoubleAccessor (&IndexedYansWifiChannel::m_rxPowerFloor),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("CellSize",
+                   "Side of the cells of the spatial grid (m).",
+                   DoubleValue (50.0),
+                   MakeDoubleAccessor (&IndexedYansWifiChannel::m_cellSize),
+                   MakeDoubleChecker<double> (0.001))
+  ;
+  return tid;
+}
+
+inline
+IndexedYansWifiChannel::IndexedYansWifiChannel ()
+  : m_rxPowerFloor (-110.0),
+    m_cellSize (50.0),
+    m_maxRxGain (0),
+    m_scheduled (0),
+    m_skipped (0)
+{
+}
+
+inline uint64_t
+IndexedYansWifiChannel::GetScheduledReceptions (void) const
+{
+  return m_scheduled;
+}
+
+inline uint64_t
+IndexedYansWifiChannel::GetSkippedReceptions (void) const
+{
+  return m_skipped;
+}
+
+inline void
+IndexedYansWifiChannel::DoDispose (void)
+{
+  Disconnect ();
+  m_loss = 0;
+  m_delay = 0;
+  m_probeA = 0;
+  m_probeB = 0;
+  YansWifiChannel::DoDispose ();
+}
+
+inline void
+IndexedYansWifiChannel::Disconnect (void)
+{
+  for (std::vector<IndexedPhy>::iterator i = m_phys.begin (); i != m_phys.end (); i++)
+    {
+      i->mobility->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&IndexedYansWifiChannel::UpdatePosition, this));
+    }
+  m_phys.clear ();
+  m_cells.clear ();
+  m_physByMobility.clear ();
+}
+
+// Reconstrói o índice a partir das PHYs do canal. As PHYs recebem o dispositivo e o nó
+// depois de SetChannel, por isso o índice é montado na primeira transmissão e refeito
+// apenas se a quantidade de PHYs mudar.
+inline void
+IndexedYansWifiChannel::Rebuild (void)
+{
+  Disconnect ();
+  PointerValue loss;
+  PointerValue delay;
+  GetAttribute ("PropagationLossModel", loss);
+  GetAttribute ("PropagationDelayModel", delay);
+  m_loss = loss.Get<PropagationLossModel> ();
+  m_delay = delay.Get<PropagationDelayModel> ();
+  m_ranges.clear ();
+  m_maxRxGain = 0;
+  if (m_probeA == 0)
+    {
+      m_probeA = CreateObject<ConstantPositionMobilityModel> ();
+      m_probeB = CreateObject<ConstantPositionMobilityModel> ();
+    }
+
+  for (std::size_t i = 0; i < GetNDevices (); i++)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (GetDevice (i));
+      NS_ASSERT (device != 0);
+      IndexedPhy entry;
+      entry.phy = DynamicCast<YansWifiPhy> (device->GetPhy ());
+      entry.mobility = entry.phy->GetMobility ();
+      NS_ASSERT (entry.mobility != 0);
+      entry.node = device->GetNode ()->GetId ();
+      entry.cell = GetCell (entry.mobility->GetPosition ());
+      m_maxRxGain = std::max (m_maxRxGain, entry.phy->GetRxGain ());
+
+      uint32_t index = m_phys.size ();
+      m_phys.push_back (entry);
+      InsertCell (entry.cell, index);
+      std::vector<uint32_t> &phys = m_physByMobility[PeekPointer (entry.mobility)];
+      if (phys.empty ())
+        {
+          entry.mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&IndexedYansWifiChannel::UpdatePosition, this));
+        }
+      phys.push_back (index);
+    }
+}
+
+inline uint64_t
+IndexedYansWifiChannel::GetCell (const Vector &position) const
+{
+  int64_t x = static_cast<int64_t> (std::floor (position.x / m_cellSize));
+  int64_t y = static_cast<int64_t> (std::floor (position.y / m_cellSize));
+  return (static_cast<uint64_t> (static_cast<uint32_t> (x)) << 32) | static_cast<uint32_t> (y);
+}
+
+inline void
+IndexedYansWifiChannel::InsertCell (uint64_t cell, uint32_t index)
+{
+  m_cells[cell].push_back (index);
+}
+
+inline void
+IndexedYansWifiChannel::RemoveCell (uint64_t cell, uint32_t index)
+{
+  std::vector<uint32_t> &phys = m_cells[cell];
+  std::vector<uint32_t>::iterator i = std::find (phys.begin (), phys.end (), index);
+  NS_ASSERT (i != phys.end ());
+  *i = phys.back ();
+  phys.pop_back ();
+  if (phys.empty ())
+    {
+      m_cells.erase (cell);
+    }
+}
+
+// Move as PHYs de um nó que mudou de posição para a sua nova célula
+inline void
+IndexedYansWifiChannel::UpdatePosition (Ptr<const MobilityModel> mobility)
+{
+  std::unordered_map<const MobilityModel *, std::vector<uint32_t> >::const_iterator i = m_physByMobility.find (PeekPointer (mobility));
+  if (i == m_physByMobility.end ())
+    {
+      return;
+    }
+  uint64_t cell = GetCell (mobility->GetPosition ());
+  for (std::vector<uint32_t>::const_iterator j = i->second.begin (); j != i->second.end (); j++)
+    {
+      IndexedPhy &entry = m_phys[*j];
+      if (entry.cell != cell)
+        {
+          RemoveCell (entry.cell, *j);
+          InsertCell (cell, *j);
+          entry.cell = cell;
+        }
+    }
+}
+
+// Maior distância em que a potência recebida ainda pode alcançar o piso, considerando o
+// maior ganho de recepção. Retorna infinito se o modelo não cair abaixo do piso até 1000 km.
+// Com o cache de propagação, a bissecção usa diretamente o modelo envolvido, para não
+// guardar no cache um valor por posição das sondas.
+inline double
+IndexedYansWifiChannel::GetRange (double txPowerDbm)
+{
+  std::map<double, double>::const_iterator cached = m_ranges.find (txPowerDbm);
+  if (cached != m_ranges.end ())
+    {
+      return cached->second;
+    }
+  Ptr<PropagationLossModel> loss = m_loss;
+  Ptr<CachedPropagationLossModel> cachedLoss = DynamicCast<CachedPropagationLossModel> (m_loss);
+  if (cachedLoss != 0)
+    {
+      loss = cachedLoss->GetModel ();
+    }
+
+  double floor = m_rxPowerFloor - m_maxRxGain;
+  m_probeA->SetPosition (Vector (0, 0, 0));
+  double near = 0;
+  double far = 1;
+  double range = std::numeric_limits<double>::infinity ();
+  for (; far <= 1e6; far *= 2)
+    {
+      m_probeB->SetPosition (Vector (far, 0, 0));
+      if (loss->CalcRxPower (txPowerDbm, m_probeA, m_probeB) < floor)
+        {
+          break;
+        }
+      near = far;
+    }
+  if (far <= 1e6)
+    {
+      // Bissecção até 1 cm
+      while (far - near > 0.01)
+        {
+          double middle = (near + far) / 2;
+          m_probeB->SetPosition (Vector (middle, 0, 0));
+          if (loss->CalcRxPower (txPowerDbm, m_probeA, m_probeB) < floor)
+            {
+              far = middle;
+            }
+          else
+            {
+              near = middle;
+            }
+        }
+      range = far;
+    }
+  m_ranges[txPowerDbm] = range;
+  return range;
+}
+
+inline void
+IndexedYansWifiChannel::SendIndexed (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm, Time duration)
+{
+  if (m_phys.size () != GetNDevices ())
+    {
+      Rebuild ();
+    }
+  Ptr<MobilityModel> senderMobility = sender->GetMobility ();
+  NS_ASSERT (senderMobility != 0);
+
+  // Candidatas: PHYs das células dentro do alcance, ou todas as PHYs se a região for
+  // maior que o próprio índice
+  m_candidates.clear ();
+  double range = GetRange (txPowerDbm);
+  double cells = std::ceil (range / m_cellSize);
+  if (cells * 2 + 1 > std::sqrt (static_cast<double> (m_phys.size ())))
+    {
+      for (uint32_t i = 0; i < m_phys.size (); i++)
+        {
+          m_candidates.push_back (i);
+        }
+    }
+  else
+    {
+      Vector position = senderMobility->GetPosition ();
+      int64_t cx = static_cast<int64_t> (std::floor (position.x / m_cellSize));
+      int64_t cy = static_cast<int64_t> (std::floor (position.y / m_cellSize));
+      int64_t n = static_cast<int64_t> (cells);
+      for (int64_t x = cx - n; x <= cx + n; x++)
+        {
+          for (int64_t y = cy - n; y <= cy + n; y++)
+            {
+              uint64_t cell = (static_cast<uint64_t> (static_cast<uint32_t> (x)) << 32) | static_cast<uint32_t> (y);
+              std::unordered_map<uint64_t, std::vector<uint32_t> >::const_iterator i = m_cells.find (cell);
+              if (i != m_cells.end ())
+                {
+                  m_candidates.insert (m_candidates.end (), i->second.begin (), i->second.end ());
+                }
+            }
+        }
+      // Mesma ordem de agendamento do YansWifiChannel (ordem de inserção das PHYs)
+      std::sort (m_candidates.begin (), m_candidates.end ());
+    }
+  m_skipped += m_phys.size () - m_candidates.size (); // o transmissor está sempre entre as candidatas
+
+  for (std::vector<uint32_t>::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      const IndexedPhy &receiver = m_phys[*i];
+      if (receiver.phy == sender)
+        {
+          continue;
+        }
+      // Assim como no YansWifiChannel, sem interferência entre canais distintos
+      if (receiver.phy->GetChannelNumber () != sender->GetChannelNumber ())
+        {
+          continue;
+        }
+      double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiver.mobility);
+      if (rxPowerDbm + receiver.phy->GetRxGain () < m_rxPowerFloor)
+        {
+          m_skipped++;
+          continue;
+        }
+      Time delay = m_delay->GetDelay (senderMobility, receiver.mobility);
+      Ptr<Packet> copy = packet->Copy ();
+      Simulator::ScheduleWithContext (receiver.node, delay, &IndexedYansWifiChannel::Receive,
+                                      receiver.phy, copy, rxPowerDbm, duration);
+      m_scheduled++;
+    }
+}
+
+inline void
+IndexedYansWifiChannel::Receive (Ptr<YansWifiPhy> receiver, Ptr<Packet> packet, double rxPowerDbm, Time duration)
+{
+  // Como no YansWifiChannel: a PHY desativada (sem mobilidade ou dispositivo) ignora o quadro
+  if (receiver->GetMobility () == 0 || receiver->GetDevice () == 0)
+    {
+      return;
+    }
+  receiver->StartReceivePreamble (packet, DbmToW (rxPowerDbm + receiver->GetRxGain ()), duration);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (IndexedYansWifiPhy);
+
+inline TypeId
+IndexedYansWifiPhy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::IndexedYansWifiPhy")
+    .SetParent<YansWifiPhy> ()
+    .AddConstructor<IndexedYansWifiPhy> ()
+  ;
+  return tid;
+}
+
+inline
+IndexedYansWifiPhy::IndexedYansWifiPhy ()
+{
+}
+
+// Mesma potência que YansWifiPhy::StartTx do ns-3.29: nível do TxVector mais o ganho
+inline void
+IndexedYansWifiPhy::StartTx (Ptr<Packet> packet, WifiTxVector txVector, Time txDuration)
+{
+  Ptr<IndexedYansWifiChannel> channel = DynamicCast<IndexedYansWifiChannel> (GetChannel ());
+  if (channel == 0)
+    {
+      YansWifiPhy::StartTx (packet, txVector, txDuration);
+      return;
+    }
+  channel->SendIndexed (this, packet, GetPowerDbm (txVector.GetTxPowerLevel ()) + GetTxGain (), txDuration);
+}
+
+inline
+IndexedYansWifiPhyHelper::IndexedYansWifiPhyHelper ()
+{
+  m_phy.SetTypeId (IndexedYansWifiPhy::GetTypeId ());
+}
+
+inline IndexedYansWifiPhyHelper
+IndexedYansWifiPhyHelper::Default (void)
+{
+  IndexedYansWifiPhyHelper helper;
+  helper.SetErrorRateModel ("ns3::NistErrorRateModel");
+  return helper;
+}
+
+// Cria um IndexedYansWifiChannel com os mesmos modelos de perda e atraso que o helper
+// configuraria em um YansWifiChannel
+inline Ptr<YansWifiChannel>
+CreateIndexedChannel (const YansWifiChannelHelper &helper, double rxPowerFloor)
+{
+  Ptr<YansWifiChannel> models = helper.Create ();
+  PointerValue loss;
+  PointerValue delay;
+  models->GetAttribute ("PropagationLossModel", loss);
+  models->GetAttribute ("PropagationDelayModel", delay);
+
+  Ptr<IndexedYansWifiChannel> channel = CreateObject<IndexedYansWifiChannel> ();
+  channel->SetAttribute ("RxPowerFloor", DoubleValue (rxPowerFloor));
+  channel->SetPropagationLossModel (loss.Get<PropagationLossModel> ());
+  channel->SetPropagationDelayModel (delay.Get<PropagationDelayModel> ());
+  return channel;
+}
+
+} // namespace ns3
+
+#endif /* INDEXED_YANS_CHANNEL_H */
@@ -0,0 +1,366 @@
+/*
+## RESUMO ##
+
+Atraso em um sentido e jitter por fluxo, medidos nos receptores, usados por trabalho.cc.
+
+> QuantileSketch: resumo de quantis em fluxo contínuo e memória limitada. Cada valor
+positivo cai no bucket i = ceil(log_gamma(v)), com gamma = (1 + a) / (1 - a), de modo
+que qualquer quantil é devolvido com erro relativo de no máximo 'a' (1% por padrão). A
+inserção custa O(1) (um logaritmo e um incremento); quando há mais de 'maxBuckets'
+buckets, os menores valores são agrupados no primeiro bucket mantido, preservando a
+precisão da cauda (p99, p999). Resumos com a mesma precisão podem ser combinados.
+> LatencyTag: instante de envio, acrescentado como byte tag a cada pacote das fontes
+TCP (OnOffApplication, trace "Tx"); o byte tag acompanha os bytes do pacote pela
+segmentação e remontagem do TCP até o PacketSink.
+> LatencyMonitor: conectado aos traces de recepção do UdpServer ("RxWithAddresses",
+atraso a partir do SeqTsHeader) e do PacketSink ("Rx", atraso a partir dos
+LatencyTag), mantém por fluxo (endereço e porta de origem) um resumo do atraso e um
+do jitter, aqui a variação absoluta do atraso entre pacotes consecutivos do fluxo
+(IPDV). Não depende do FlowMonitor nem dos seus histogramas.
+*/
+
+#ifndef LATENCY_SKETCH_H
+#define LATENCY_SKETCH_H
+
+#include "ns3/application.h"
+#include "ns3/packet.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/simulator.h"
+#include "ns3/tag.h"
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+class QuantileSketch
+{
+public:
+  QuantileSketch (double relativeAccuracy = 0.01, uint32_t maxBuckets = 2048);
+
+  void Add (double value);
+  void Merge (const QuantileSketch &other);
+  void Clear (void);
+  uint64_t GetCount (void) const;
+  double GetQuantile (double q) const;
+
+private:
+  void AddToBucket (int32_t index, uint64_t count);
+
+  double m_gamma;
+  double m_logGamma;
+  uint32_t m_maxBuckets;
+  std::vector<uint64_t> m_buckets; // m_buckets[i] conta os valores do bucket m_offset + i
+  int32_t m_offset;
+  uint64_t m_zeros;
+  uint64_t m_count;
+};
+
+inline
+QuantileSketch::QuantileSketch (double relativeAccuracy, uint32_t maxBuckets)
+  : m_gamma ((1 + relativeAccuracy) / (1 - relativeAccuracy)),
+    m_logGamma (std::log (m_gamma)),
+    m_maxBuckets (maxBuckets),
+    m_offset (0),
+    m_zeros (0),
+    m_count (0)
+{
+}
+
+inline void
+QuantileSketch::Add (double value)
+{
+  const double minValue = 1e-9; // valores menores contam como zero
+  m_count++;
+  if (value < minValue)
+    {
+      m_zeros++;
+      return;
+    }
+  AddToBucket (static_cast<int32_t> (std::ceil (std::log (value) / m_logGamma)), 1);
+}
+
+inline void
+QuantileSketch::AddToBucket (int32_t index, uint64_t count)
+{
+  if (m_buckets.empty ())
+    {
+      m_offset = index;
+    }
+  if (index < m_offset)
+    {
+      // Novo mínimo: raro depois dos primeiros valores
+      m_buckets.insert (m_buckets.begin (), m_offset - index, 0);
+      m_offset = index;
+    }
+  else if (index >= m_offset + static_cast<int32_t> (m_buckets.size ()))
+    {
+      m_buckets.resize (index - m_offset + 1, 0);
+    }
+  m_buckets[index - m_offset] += count;
+
+  if (m_buckets.size () > m_maxBuckets)
+    {
+      // Agrupa os menores valores para manter a memória limitada
+      uint32_t excess = m_buckets.size () - m_maxBuckets;
+      for (uint32_t i = 0; i < excess; i++)
+        {
+          m_buckets[excess] += m_buckets[i];
+        }
+      m_buckets.erase (m_buckets.begin (), m_buckets.begin () + excess);
+      m_offset += excess;
+    }
+}
+
+// Acrescenta os valores de 'other', que deve ter a mesma precisão
+inline void
+QuantileSketch::Merge (const QuantileSketch &other)
+{
+  NS_ASSERT (m_gamma == other.m_gamma);
+  m_count += other.m_count;
+  m_zeros += other.m_zeros;
+  for (uint32_t i = 0; i < other.m_buckets.size (); i++)
+    {
+      if (other.m_buckets[i] > 0)
+        {
+          AddToBucket (other.m_offset + i, other.m_buckets[i]);
+        }
+    }
+}
+
+inline void
+QuantileSketch::Clear (void)
+{
+  m_buckets.clear ();
+  m_offset = 0;
+  m_zeros = 0;
+  m_count = 0;
+}
+
+inline uint64_t
+QuantileSketch::GetCount (void) const
+{
+  return m_count;
+}
+
+// Quantil 'q' (0 a 1); zero se não houver valores
+inline double
+QuantileSketch::GetQuantile (double q) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  double rank = q * (m_count - 1);
+  uint64_t cumulative = m_zeros;
+  if (rank < cumulative)
+    {
+      return 0;
+    }
+  for (uint32_t i = 0; i < m_buckets.size (); i++)
+    {
+      cumulative += m_buckets[i];
+      if (rank < cumulative)
+        {
+          return 2 * std::pow (m_gamma, m_offset + static_cast<int32_t> (i)) / (m_gamma + 1);
+        }
+    }
+  return 2 * std::pow (m_gamma, m_offset + static_cast<int32_t> (m_buckets.size ()) - 1) / (m_gamma + 1);
+}
+
+// Instante de envio de um pacote, como byte tag
+class LatencyTag : public Tag
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  LatencyTag ();
+  LatencyTag (Time sent);
+
+  Time GetSent (void) const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  Time m_sent;
+};
+
+// Uma variável de registro por unidade de tradução; o TypeId, estático de uma função
+// inline, é criado uma única vez
+NS_OBJECT_ENSURE_REGISTERED (LatencyTag);
+
+inline TypeId
+LatencyTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LatencyTag")
+    .SetParent<Tag> ()
+    .AddConstructor<LatencyTag> ()
+  ;
+  return tid;
+}
+
+inline TypeId
+LatencyTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+inline
+LatencyTag::LatencyTag ()
+{
+}
+
+inline
+LatencyTag::LatencyTag (Time sent)
+  : m_sent (sent)
+{
+}
+
+inline Time
+LatencyTag::GetSent (void) const
+{
+  return m_sent;
+}
+
+inline uint32_t
+LatencyTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+inline void
+LatencyTag::Serialize (TagBuffer i) const
+{
+  i.WriteU64 (m_sent.GetNanoSeconds ());
+}
+
+inline void
+LatencyTag::Deserialize (TagBuffer i)
+{
+  m_sent = NanoSeconds (i.ReadU64 ());
+}
+
+inline void
+LatencyTag::Print (std::ostream &os) const
+{
+  os << "sent=" << m_sent;
+}
+
+class LatencyMonitor
+{
+public:
+  void ConnectUdpServer (Ptr<Application> server);
+  void ConnectPacketSink (Ptr<Application> sink);
+  static void TagTcpSource (Ptr<Application> source);
+  void Reset (void);
+  void Summarize (QuantileSketch &latency, QuantileSketch &jitter) const;
+
+private:
+  struct Flow
+  {
+    QuantileSketch latency; // atraso em um sentido [s]
+    QuantileSketch jitter; // variação do atraso entre pacotes consecutivos [s]
+    double lastDelay; // negativo antes do primeiro pacote
+    Flow () : lastDelay (-1) {}
+  };
+
+  void UdpServerRx (Ptr<const Packet> packet, const Address &from, const Address &to);
+  void PacketSinkRx (Ptr<const Packet> packet, const Address &from);
+  static void TagPacket (Ptr<const Packet> packet);
+  void Record (const Address &from, Time sent);
+
+  std::unordered_map<uint64_t, Flow> m_flows; // endereço IPv4 e porta de origem -> fluxo
+};
+
+inline void
+LatencyMonitor::ConnectUdpServer (Ptr<Application> server)
+{
+  server->TraceConnectWithoutContext ("RxWithAddresses", MakeCallback (&LatencyMonitor::UdpServerRx, this));
+}
+
+inline void
+LatencyMonitor::ConnectPacketSink (Ptr<Application> sink)
+{
+  sink->TraceConnectWithoutContext ("Rx", MakeCallback (&LatencyMonitor::PacketSinkRx, this));
+}
+
+// Marca com o instante de envio cada pacote entregue ao socket pela fonte (OnOffApplication)
+inline void
+LatencyMonitor::TagTcpSource (Ptr<Application> source)
+{
+  source->TraceConnectWithoutContext ("Tx", MakeCallback (&LatencyMonitor::TagPacket));
+}
+
+// Descarta as medições, por exemplo, no início do tráfego de um novo ponto
+inline void
+LatencyMonitor::Reset (void)
+{
+  m_flows.clear ();
+}
+
+// Combina os resumos de todos os fluxos
+inline void
+LatencyMonitor::Summarize (QuantileSketch &latency, QuantileSketch &jitter) const
+{
+  for (std::unordered_map<uint64_t, Flow>::const_iterator i = m_flows.begin (); i != m_flows.end (); i++)
+    {
+      latency.Merge (i->second.latency);
+      jitter.Merge (i->second.jitter);
+    }
+}
+
+inline void
+LatencyMonitor::UdpServerRx (Ptr<const Packet> packet, const Address &from, const Address &to)
+{
+  SeqTsHeader seqTs;
+  packet->PeekHeader (seqTs);
+  Record (from, seqTs.GetTs ());
+}
+
+// Cada byte tag recebido é uma parte de um pacote da fonte: um valor de atraso por parte
+inline void
+LatencyMonitor::PacketSinkRx (Ptr<const Packet> packet, const Address &from)
+{
+  ByteTagIterator i = packet->GetByteTagIterator ();
+  while (i.HasNext ())
+    {
+      ByteTagIterator::Item item = i.Next ();
+      if (item.GetTypeId () == LatencyTag::GetTypeId ())
+        {
+          LatencyTag tag;
+          item.GetTag (tag);
+          Record (from, tag.GetSent ());
+        }
+    }
+}
+
+inline void
+LatencyMonitor::TagPacket (Ptr<const Packet> packet)
+{
+  packet->AddByteTag (LatencyTag (Simulator::Now ()));
+}
+
+inline void
+LatencyMonitor::Record (const Address &from, Time sent)
+{
+  InetSocketAddress source = InetSocketAddress::ConvertFrom (from);
+  uint64_t key = (static_cast<uint64_t> (source.GetIpv4 ().Get ()) << 16) | source.GetPort ();
+  Flow &flow = m_flows[key];
+  double delay = (Simulator::Now () - sent).GetSeconds ();
+  flow.latency.Add (delay);
+  if (flow.lastDelay >= 0)
+    {
+      flow.jitter.Add (std::fabs (delay - flow.lastDelay));
+    }
+  flow.lastDelay = delay;
+}
+
+} // namespace ns3
+
+#endif /* LATENCY_SKETCH_H */
@@ -42,6 +42,57 @@ o mais próximo de sta_x,sta_y. Por exemplo:
 sta_x = 1.0; sta_y = 2.0
 steps = 1; stepSize = 0.1 (m); stepTime = 1 (s)
 P: 1.1;2.1
+(3) Levantamento em uma única simulação ("surveyFile")
+- Os pontos "x y [z]" do arquivo (um por linha) são percorridos pela primeira
+STA, um a cada "stepsTime", sem reconstruir a topologia nem reiniciar o
+controle de taxa e potência entre os pontos. O resultado de cada ponto é gravado
+em "survey-<outputFileName>.csv".
+> Replicações independentes ("replications", "ciTarget", "workers")
+- O PARF/APARF/RRPAA é estocástico, portanto uma única execução não basta. Com
+replications = K > 1, o cenário é simulado com os números de execução RngRun,
+RngRun + 1, ..., em até "workers" processos paralelos. A vazão e a potência média
+de cada par (AP, STA) a cada passo são combinadas em média, variância e intervalo
+de confiança de 95%, e as replicações param antes de K quando todas as
+semi-amplitudes ficam abaixo de "ciTarget" vezes a média (após "minReplications").
+O resultado é gravado em "replications-<outputFileName>.csv".
+> Vários APs e STAs ("nAps" e "nStas"):
+- Os APs ficam ao longo do eixo x, separados por "apSpacing", a partir de
+(AP1_x, AP1_y). A STA 's' associa-se ao AP 's % nAps' (cada AP tem seu SSID) e
+fica na posição (STA1_x, STA1_y) relativa ao seu AP, deslocada de "staSpacing"
+em y para cada STA anterior do mesmo AP. Cada AP envia um fluxo para cada STA.
+- Vazão, potência média e ocupação do meio são registradas por par (AP, STA) a
+cada passo no arquivo "pairs-<outputFileName>.csv"; os gráficos do gnuplot têm
+um conjunto de dados por AP.
+> Série temporal ("series-<outputFileName>.bin", "plotSeries"):
+- A cada passo, cada AP acrescenta uma linha (instante, posição da sua primeira
+STA, vazão, potência média e a taxa e a potência atuais da primeira STA) a um
+arquivo binário colunar, gravado em blocos de 1024 linhas durante a simulação, de
+modo que a memória não cresce com a quantidade de passos. Os arquivos do gnuplot
+são gerados a partir desse arquivo ao fim da simulação, ou depois, com
+plotSeries=<arquivo> (sem simular).
+> Cache de propagação ("cachePropagation"):
+- Invalidado a cada movimento das STAs; com checkCache = 1, a simulação falha se o
+cache passar de um valor por par de nós e potência de transmissão.
+> Canal indexado ("indexedChannel", "rxPowerFloor"):
+- Para levantamentos com muitos nós, as PHYs ficam em uma grade espacial e cada
+quadro só é entregue às PHYs em que a potência recebida chega a "rxPowerFloor"
+(dBm); a grade acompanha o movimento das STAs a cada passo. Sinais abaixo do
+piso deixam de contar como interferência.
+> Perfil de execução ("profile", "profileFile"):
+- Um resumo por replicação (profiler.h), na saída de erro ou em "profileFile".
+> Passos adaptativos ("convergenceTarget", "batchTime", "minBatches"):
+- Com convergenceTarget > 0, os bytes recebidos por cada par (AP, STA) são
+amostrados em janelas de "batchTime" segundos, e o passo (ou ponto do
+levantamento) termina assim que a vazão de todos os pares passa no teste de estado
+estacionário de running-statistics.h, com pelo menos "minBatches" lotes e
+semi-amplitude do intervalo de 95% abaixo de convergenceTarget vezes a média.
+"stepsTime" passa a ser a duração máxima de cada passo, e vazão, potência e
+ocupação do meio são médias sobre a duração efetiva do passo.
+> Tabela de tempos de transmissão:
+- Os modos da PHY do AP e o tempo de transmissão do pacote ("packetSize") em cada
+modo são calculados uma única vez por configuração de PHY (tx-duration-cache.h)
+e compartilhados por todos os APs e replicações simulados no mesmo processo. Todo
+quadro de dados é contabilizado com o tempo desse pacote, no modo atual da estação.
 
 /*
 ## BIBLIOTECAS ##
@@ -63,6 +114,17 @@ P: 1.1;2.1
 #16 - wifi-mac: trabalha os objetos relacionadas ao MAC address
 #17 - wifi-mac-header: implementa o cabeçalho do MAC address
 #18 - mobility-model: trabalha informações de posição e velocidade de um objeto
+#19 - algorithm/unordered_map: std::max e tabelas hash usadas para localizar as
+       estações pelo endereço MAC e o modo pela taxa
+#20 - sstream: monta os SSIDs e os caminhos de Config de cada AP
+#21 - rng-seed-manager: define o número de execução de cada replicação
+#22 - poll/sys/wait/unistd/signal: processos filhos que executam as replicações em paralelo
+#23 - propagation-cache: cache da perda e do atraso de propagação entre os nós
+#24 - indexed-yans-channel: canal que só agenda recepções acima de um piso de potência
+#25 - profiler: tempo de parede por fase, eventos executados e pico de memória
+#26 - running-statistics: média e intervalo de confiança das replicações e teste de
+       convergência dos passos adaptativos
+#27 - tx-duration-cache: tabela de modos e tempos de transmissão compartilhada pelos APs
 */
 
 #include "ns3/gnuplot.h"
@@ -83,6 +145,25 @@ P: 1.1;2.1
 #include "ns3/wifi-mac.h"
 #include "ns3/wifi-mac-header.h"
 #include "ns3/mobility-model.h"
+#include "ns3/rng-seed-manager.h"
+#include "propagation-cache.h"
+#include "indexed-yans-channel.h"
+#include "profiler.h"
+#include "running-statistics.h"
+#include "tx-duration-cache.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <unordered_map>
 
 using namespace ns3;
 using namespace std;
@@ -90,8 +171,195 @@ using namespace std;
 // Definição do componente de log: PowerAdaptationDistance
 NS_LOG_COMPONENT_DEFINE ("PowerAdaptationDistance");
 
-// Tamanho do pacote gerado no AP (bytes)
-static const uint32_t packetSize = 1420;
+// Tamanho padrão do pacote gerado no AP (bytes)
+static const uint32_t defaultPacketSize = 1420;
+
+// Linha da série temporal: o resultado de um AP ao fim de um passo, com a posição e o
+// estado atual (taxa e potência) da sua primeira STA
+struct SeriesRow
+{
+  double time; // instante do fim do passo (s)
+  uint32_t ap; // índice do AP
+  double x; // posição da primeira STA do AP
+  double y;
+  double throughput; // vazão total do AP no passo (Mbit/s)
+  double averagePower; // potência média transmitida pelo AP no passo
+  double rate; // taxa atual da primeira STA (Mbit/s)
+  double power; // potência atual da primeira STA (dBm)
+};
+
+// Colunas reais da série, na ordem em que são gravadas em cada bloco
+static double SeriesRow::*const g_seriesColumns[] = { &SeriesRow::time, &SeriesRow::x, &SeriesRow::y,
+                                                      &SeriesRow::throughput, &SeriesRow::averagePower,
+                                                      &SeriesRow::rate, &SeriesRow::power };
+static const uint32_t g_seriesNColumns = sizeof (g_seriesColumns) / sizeof (g_seriesColumns[0]) + 1;
+static const char g_seriesMagic[8] = { 'P', 'A', 'S', 'E', 'R', 'I', 'E', '1' };
+
+// Gravação da série temporal em um arquivo binário colunar. Após o cabeçalho
+// ("PASERIE1" e o número de colunas), as linhas são gravadas em blocos de até
+// 'blockRows': o número de linhas do bloco, a coluna 'ap' (uint32_t) e em seguida cada
+// coluna real (double), na ordem da máquina. Apenas o bloco atual fica em memória.
+class SeriesWriter
+{
+public:
+  SeriesWriter (const std::string &fileName, uint32_t blockRows);
+  ~SeriesWriter ();
+
+  void Append (const SeriesRow &row);
+  void Close (void);
+
+private:
+  void Flush (void);
+
+  std::ofstream m_file;
+  std::string m_fileName;
+  uint32_t m_blockRows;
+  std::vector<SeriesRow> m_rows; // bloco atual
+  std::vector<double> m_column; // coluna sendo gravada
+};
+
+SeriesWriter::SeriesWriter (const std::string &fileName, uint32_t blockRows)
+  : m_file (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc),
+    m_fileName (fileName),
+    m_blockRows (blockRows)
+{
+  if (!m_file)
+    {
+      NS_FATAL_ERROR ("Cannot open series file " << fileName);
+    }
+  m_file.write (g_seriesMagic, sizeof (g_seriesMagic));
+  m_file.write (reinterpret_cast<const char *> (&g_seriesNColumns), sizeof (g_seriesNColumns));
+  m_rows.reserve (blockRows);
+}
+
+SeriesWriter::~SeriesWriter ()
+{
+  Close ();
+}
+
+void
+SeriesWriter::Append (const SeriesRow &row)
+{
+  m_rows.push_back (row);
+  if (m_rows.size () == m_blockRows)
+    {
+      Flush ();
+    }
+}
+
+// Grava o bloco pendente e fecha o arquivo
+void
+SeriesWriter::Close (void)
+{
+  if (m_file.is_open ())
+    {
+      Flush ();
+      m_file.close ();
+    }
+}
+
+void
+SeriesWriter::Flush (void)
+{
+  if (m_rows.empty ())
+    {
+      return;
+    }
+  uint32_t rows = m_rows.size ();
+  m_file.write (reinterpret_cast<const char *> (&rows), sizeof (rows));
+  for (uint32_t i = 0; i < rows; i++)
+    {
+      m_file.write (reinterpret_cast<const char *> (&m_rows[i].ap), sizeof (m_rows[i].ap));
+    }
+  m_column.resize (rows);
+  for (uint32_t c = 0; c + 1 < g_seriesNColumns; c++)
+    {
+      for (uint32_t i = 0; i < rows; i++)
+        {
+          m_column[i] = m_rows[i].*g_seriesColumns[c];
+        }
+      m_file.write (reinterpret_cast<const char *> (&m_column[0]), rows * sizeof (double));
+    }
+  if (!m_file)
+    {
+      NS_FATAL_ERROR ("Cannot write series file " << m_fileName << ": " << std::strerror (errno));
+    }
+  m_rows.clear ();
+}
+
+// Leitura sequencial, linha a linha, de um arquivo gravado pelo SeriesWriter
+class SeriesReader
+{
+public:
+  SeriesReader (const std::string &fileName);
+
+  bool Next (SeriesRow &row);
+
+private:
+  bool ReadBlock (void);
+
+  std::ifstream m_file;
+  std::string m_fileName;
+  std::vector<SeriesRow> m_rows; // bloco atual
+  std::vector<double> m_column;
+  uint32_t m_next; // próxima linha do bloco atual
+};
+
+SeriesReader::SeriesReader (const std::string &fileName)
+  : m_file (fileName.c_str (), std::ios::in | std::ios::binary),
+    m_fileName (fileName),
+    m_next (0)
+{
+  char magic[sizeof (g_seriesMagic)];
+  uint32_t columns = 0;
+  m_file.read (magic, sizeof (magic));
+  m_file.read (reinterpret_cast<char *> (&columns), sizeof (columns));
+  if (!m_file || std::memcmp (magic, g_seriesMagic, sizeof (magic)) != 0 || columns != g_seriesNColumns)
+    {
+      NS_FATAL_ERROR (fileName << " is not a series file written by this program");
+    }
+}
+
+bool
+SeriesReader::Next (SeriesRow &row)
+{
+  if (m_next == m_rows.size () && !ReadBlock ())
+    {
+      return false;
+    }
+  row = m_rows[m_next++];
+  return true;
+}
+
+bool
+SeriesReader::ReadBlock (void)
+{
+  uint32_t rows = 0;
+  if (!m_file.read (reinterpret_cast<char *> (&rows), sizeof (rows)) || rows == 0)
+    {
+      return false;
+    }
+  m_rows.resize (rows);
+  m_column.resize (rows);
+  for (uint32_t i = 0; i < rows; i++)
+    {
+      m_file.read (reinterpret_cast<char *> (&m_rows[i].ap), sizeof (m_rows[i].ap));
+    }
+  for (uint32_t c = 0; c + 1 < g_seriesNColumns; c++)
+    {
+      m_file.read (reinterpret_cast<char *> (&m_column[0]), rows * sizeof (double));
+      for (uint32_t i = 0; i < rows; i++)
+        {
+          m_rows[i].*g_seriesColumns[c] = m_column[i];
+        }
+    }
+  if (!m_file)
+    {
+      NS_FATAL_ERROR (m_fileName << ": truncated block");
+    }
+  m_next = 0;
+  return true;
+}
 
 // Classe para definir os parâmetros referentes aos nós da rede 
 class NodeStatistics
@@ -102,49 +370,71 @@ class NodeStatistics
 // 1) Vazão vs tempo conforme a mobilidade (não será utilizado)
 // 2) Potência vs tempo conforme a mobilidade (será utilizado para o cálculo do RSSI)
 public:
-  NodeStatistics (NetDeviceContainer aps, NetDeviceContainer stas);
+  NodeStatistics (NetDeviceContainer aps, NetDeviceContainer stas, uint32_t packetSize);
 
   void PhyCallback (std::string path, Ptr<const Packet> packet);
-  void RxCallback (std::string path, Ptr<const Packet> packet, const Address &from);
+  void RxCallback (uint32_t station, Ptr<const Packet> packet);
   void PowerCallback (std::string path, double oldPower, double newPower, Mac48Address dest);
   void RateCallback (std::string path, DataRate oldRate, DataRate newRate, Mac48Address dest);
-  void SetPosition (Ptr<Node> node, Vector position);
-  void AdvancePosition (Ptr<Node> node, int stepsSize, int stepsTime);
-  Vector GetPosition (Ptr<Node> node);
-
-  Gnuplot2dDataset GetDatafile ();
-  Gnuplot2dDataset GetPowerDatafile ();
+  void Sample (double stepsTime, std::ostream &os);
+  uint64_t GetStepBytes (uint32_t station) const;
+  void GetLastSample (uint32_t station, double &throughput, double &power, double &airtime) const;
+  uint32_t GetNStations (void) const;
+  void SetSeries (SeriesWriter *series, uint32_t ap);
 
 // Método privado
 /*
-   1) Define-se um par ordenado ou conjunto de palavra-chave 
-   para associar DataRate (Vazão) e TxTime (Tempo de transmissão).
-   2) Mapeia os valores atuais de Potência e Vazão.
+   1) Tabela de tempos de transmissão (TxTime) do pacote do AP indexada pelo modo da
+   PHY, obtida em SetupPhy do TxDurationCache e compartilhada por todos os APs com a
+   mesma configuração de PHY.
+   2) Estado atual de Potência e Vazão de cada estação, guardado em um vetor denso;
+   o endereço MAC é convertido no índice da estação por uma tabela hash.
    3) Definição de: vazão total, energia e tempo totais.
 */
 private:
-  typedef std::vector<std::pair<Time, DataRate> > TxTime;
+  // Estado de uma estação destino. A potência já fica convertida para mW e o tempo de
+  // transmissão já fica resolvido, para que PhyCallback apenas acumule os valores.
+  struct Station
+  {
+    double power; // potência atual (dBm)
+    double powerMw; // potência atual (mW)
+    uint32_t mode; // índice do modo atual na PHY
+    double txTime; // tempo de transmissão de um pacote no modo atual (s)
+    Ptr<Node> node; // nó da STA (nulo para o endereço de broadcast)
+    uint64_t bytes; // bytes recebidos pela STA no passo atual
+    double energy; // energia transmitida pelo AP para a STA no passo atual
+    double time; // tempo de transmissão do AP para a STA no passo atual (s)
+    double lastThroughput; // vazão no último passo concluído (Mbit/s)
+    double lastPower; // potência média transmitida no último passo concluído
+    double lastAirtime; // ocupação do meio no último passo concluído
+  };
+
   void SetupPhy (Ptr<WifiPhy> phy);
-  Time GetCalcTxTime (DataRate rate);
-
-  std::map<Mac48Address, double> currentPower;
-  std::map<Mac48Address, DataRate> currentRate;
-  uint32_t m_bytesTotal;
-  double totalEnergy;
-  double totalTime;
-  Ptr<WifiPhy> myPhy;
-  TxTime timeTable;
-  Gnuplot2dDataset m_output;
-  Gnuplot2dDataset m_output_power;
+  static uint64_t GetKey (Mac48Address address);
+  Station *GetStation (Mac48Address address);
+  void UpdateTxTime (Station &station);
+
+  std::unordered_map<uint64_t, uint32_t> m_stationIndex; // endereço MAC -> posição em m_stations
+  std::vector<Station> m_stations;
+  uint32_t m_packetSize; // tamanho do pacote enviado pelo AP (bytes)
+  const ModeTable *m_table; // modos e tempos de transmissão (compartilhada, imutável)
+  Ptr<Node> m_apNode;
+  SeriesWriter *m_series; // série temporal (nula quando não há arquivos de saída)
+  uint32_t m_apIndex; // índice do AP nas linhas da série
 };
 
 /*
   1) Utilizando a classe "NodeStatistics" os parâmetros são os NetDeviceContainers 
-     tanto para o AP quanto para a STA (dispositivo utilizando o WiFi).
+     tanto para o AP quanto para as STAs associadas a ele (dispositivo utilizando o WiFi).
+     Há uma instância por AP; a estação 'j' é a j-ésima STA de 'stas'.
   2) Os NetDeviceContainers inicializam os dispositivos, adicionando o endereço MAC
      e realizando a instalação do nó da rede. 
 */
-NodeStatistics::NodeStatistics (NetDeviceContainer aps, NetDeviceContainer stas)
+NodeStatistics::NodeStatistics (NetDeviceContainer aps, NetDeviceContainer stas, uint32_t packetSize)
+  : m_packetSize (packetSize),
+    m_table (0),
+    m_series (0),
+    m_apIndex (0)
 {
 // NetDevice e WifiNetDevice resguardam todos os objetos relacionados ao WiFi,
 // ou seja, atributos como: canal, configuração das camadas PHY e MAC atribuídos
@@ -152,86 +442,100 @@ NodeStatistics::NodeStatistics (NetDeviceContainer aps, NetDeviceContainer stas)
   Ptr<NetDevice> device = aps.Get (0); // Configurando AP
   Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice> (device);
   Ptr<WifiPhy> phy = wifiDevice->GetPhy ();
-  myPhy = phy;
+  m_apNode = device->GetNode ();
   SetupPhy (phy);
 // Por exemplo, com base na configuração do NetDevice, a Vazão tem por base os 
 // parâmetros da camada PHY e largura do canal. 
-  DataRate dataRate = DataRate (phy->GetMode (0).GetDataRate (phy->GetChannelWidth ()));
-  double power = phy->GetTxPowerEnd ();
+// Todas as estações começam no modo 0 (menor vazão) e com a potência máxima.
+  Station initial;
+  initial.power = phy->GetTxPowerEnd ();
+  initial.powerMw = pow (10.0, initial.power / 10.0);
+  initial.mode = 0;
+  initial.bytes = 0;
+  initial.energy = 0;
+  initial.time = 0;
+  initial.lastThroughput = 0;
+  initial.lastPower = 0;
+  initial.lastAirtime = 0;
+  UpdateTxTime (initial);
   for (uint32_t j = 0; j < stas.GetN (); j++) // Configurando STA
     {
       Ptr<NetDevice> staDevice = stas.Get (j);
       Ptr<WifiNetDevice> wifiStaDevice = DynamicCast<WifiNetDevice> (staDevice);
       Mac48Address addr = wifiStaDevice->GetMac ()->GetAddress ();
 // Dados atuais de potência e vazão para STA
-      currentPower[addr] = power;
-      currentRate[addr] = dataRate;
+      m_stationIndex[GetKey (addr)] = m_stations.size ();
+      m_stations.push_back (initial);
+      m_stations.back ().node = staDevice->GetNode ();
     }
-  currentRate[Mac48Address ("ff:ff:ff:ff:ff:ff")] = dataRate;
-  totalEnergy = 0;
-  totalTime = 0;
-  m_bytesTotal = 0;
-// Define a saída no arquivo de dados para o gnuplot: 
-// Vazão (Mbps) e Potência Média (W)
-  m_output.SetTitle ("Throughput [Mbits/s]");
-  m_output_power.SetTitle ("Potência Transmitida [W]");
+  m_stationIndex[GetKey (Mac48Address::GetBroadcast ())] = m_stations.size ();
+  m_stations.push_back (initial);
 }
 
-// Função para configuração da camada PHY
+// Função para configuração da camada PHY: tempo de transmissão do pacote em cada modo e
+// índice do modo de cada taxa, calculados uma única vez por configuração
 void
 NodeStatistics::SetupPhy (Ptr<WifiPhy> phy)
 {
-  uint32_t nModes = phy->GetNModes ();
-  for (uint32_t i = 0; i < nModes; i++)
-    {
-      WifiMode mode = phy->GetMode (i);
-      WifiTxVector txVector;
-      txVector.SetMode (mode);
 /* O PREAMBLE_TYPE é o tempo de espera e sincronização
    antes da transmissão de um quadro. Sendo assim, é
    utilizado como sincronismo que configura confiabilidade
    na transmissão, ou seja, não há transmissão de dados.
 */
-      txVector.SetPreambleType (WIFI_PREAMBLE_LONG);
-// Configuração da largura do canal
-      txVector.SetChannelWidth (phy->GetChannelWidth ());
-// Vazão
-      DataRate dataRate = DataRate (mode.GetDataRate (phy->GetChannelWidth ()));
-// Duração da transmissão
-      Time time = phy->CalculateTxDuration (packetSize, txVector, phy->GetFrequency ());
-      NS_LOG_DEBUG (i << " " << time.GetSeconds () << " " << dataRate);
-      timeTable.push_back (std::make_pair (time, dataRate));
+  m_table = &TxDurationCache::GetModeTable (phy, WIFI_PREAMBLE_LONG, std::vector<uint32_t> (1, m_packetSize));
+}
+
+// Chave da tabela hash: os 6 bytes do endereço MAC
+uint64_t
+NodeStatistics::GetKey (Mac48Address address)
+{
+  uint8_t buffer[6];
+  address.CopyTo (buffer);
+  uint64_t key = 0;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      key = (key << 8) | buffer[i];
     }
+  return key;
 }
 
-// Verifica o intervalo de transmissão
-Time
-NodeStatistics::GetCalcTxTime (DataRate rate)
+// Estado da estação com o endereço informado (0 se a estação não é conhecida)
+NodeStatistics::Station *
+NodeStatistics::GetStation (Mac48Address address)
 {
-  for (TxTime::const_iterator i = timeTable.begin (); i != timeTable.end (); i++)
+  std::unordered_map<uint64_t, uint32_t>::const_iterator i = m_stationIndex.find (GetKey (address));
+  if (i == m_stationIndex.end ())
     {
-      if (rate == i->second)
-        {
-          return i->first;
-        }
+      return 0;
     }
-  NS_ASSERT (false);
-  return Seconds (0);
+  return &m_stations[i->second];
 }
 
-// Cálculo da energia e do tempo total de transmissão para cálculo da potência média.
+// Atualiza o tempo de transmissão da estação após mudança de modo
+void
+NodeStatistics::UpdateTxTime (Station &station)
+{
+  station.txTime = m_table->txTimes[station.mode];
+}
 
+// Cálculo da energia e do tempo total de transmissão para cálculo da potência média.
+// Executado a cada quadro transmitido: apenas uma consulta à tabela hash, independente
+// da quantidade de estações.
 void
 NodeStatistics::PhyCallback (std::string path, Ptr<const Packet> packet)
 {
   WifiMacHeader head;
   packet->PeekHeader (head);
-  Mac48Address dest = head.GetAddr1 ();
 
   if (head.GetType () == WIFI_MAC_DATA)
     {
-      totalEnergy += pow (10.0, currentPower[dest] / 10.0) * GetCalcTxTime (currentRate[dest]).GetSeconds ();
-      totalTime += GetCalcTxTime (currentRate[dest]).GetSeconds ();
+      Station *station = GetStation (head.GetAddr1 ());
+      if (station == 0)
+        {
+          return;
+        }
+      station->energy += station->powerMw * station->txTime;
+      station->time += station->txTime;
     }
 }
 
@@ -239,67 +543,370 @@ NodeStatistics::PhyCallback (std::string path, Ptr<const Packet> packet)
 void
 NodeStatistics::PowerCallback (std::string path, double oldPower, double newPower, Mac48Address dest)
 {
-  currentPower[dest] = newPower;
+  Station *station = GetStation (dest);
+  if (station != 0)
+    {
+      station->power = newPower;
+      station->powerMw = pow (10.0, newPower / 10.0);
+    }
 }
 
 // Atribuição de valores para Vazão
 void
 NodeStatistics::RateCallback (std::string path, DataRate oldRate, DataRate newRate, Mac48Address dest)
 {
-  currentRate[dest] = newRate;
+  Station *station = GetStation (dest);
+  if (station != 0)
+    {
+      std::unordered_map<uint64_t, uint32_t>::const_iterator i = m_table->modeIndex.find (newRate.GetBitRate ());
+      NS_ASSERT (i != m_table->modeIndex.end ());
+      station->mode = i->second;
+      UpdateTxTime (*station);
+    }
 }
 
-// Atribuição de valor a M_bytes com base no tamanho de pacotes transmitidos
+// Atribuição de valor aos bytes recebidos pela estação 'station'
 void
-NodeStatistics::RxCallback (std::string path, Ptr<const Packet> packet, const Address &from)
+NodeStatistics::RxCallback (uint32_t station, Ptr<const Packet> packet)
 {
-  m_bytesTotal += packet->GetSize ();
+  m_stations[station].bytes += packet->GetSize ();
 }
 
 // Configuração da mobilidade do nó STA
-void
-NodeStatistics::SetPosition (Ptr<Node> node, Vector position)
+static void
+SetPosition (Ptr<Node> node, Vector position)
 {
   Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
   mobility->SetPosition (position);
 }
-Vector
-NodeStatistics::GetPosition (Ptr<Node> node)
+static Vector
+GetPosition (Ptr<Node> node)
 {
   Ptr<MobilityModel> mobility = node->GetObject<MobilityModel> ();
   return mobility->GetPosition ();
 }
 
+// Fecha o passo atual: grava uma linha por par (AP, STA) com vazão, potência média e
+// ocupação do meio, acrescenta o total do AP à série temporal e zera os contadores.
 void
-NodeStatistics::AdvancePosition (Ptr<Node> node, int stepsSize, int stepsTime)
-{
-  Vector pos = GetPosition (node);
-  double mbs = ((m_bytesTotal * 8.0) / (1000000 * stepsTime)); // cálculo de mbs
-  m_bytesTotal = 0; // inicialização de m_bytesTotal
-  double atp = totalEnergy / stepsTime; // average transmission power (atp)
-  totalEnergy = 0; // inicialização de totalEnergy
-  totalTime = 0; // inicialização de totalTime
-  m_output_power.Add (pos.x, atp);
-  m_output.Add (pos.x, mbs);
-// A posição do nó é incrementada com base no tamanho do passo (stepsSize)
-// Para realizar medições ponto a ponto, um de cada vez, será utilizado 1 passo apenas.
-  pos.x += stepsSize;
-  SetPosition (node, pos);
-  NS_LOG_INFO ("No intervalo de " << Simulator::Now ().GetSeconds () << " segundos; configurando nova posição para " << pos);
-  Simulator::Schedule (Seconds (stepsTime), &NodeStatistics::AdvancePosition, this, node, stepsSize, stepsTime);
+NodeStatistics::Sample (double stepsTime, std::ostream &os)
+{
+  double bytesTotal = 0;
+  double totalEnergy = 0;
+  for (uint32_t j = 0; j < m_stations.size (); j++)
+    {
+      Station &station = m_stations[j];
+      bytesTotal += station.bytes;
+      totalEnergy += station.energy;
+      station.lastThroughput = (station.bytes * 8.0) / (1000000 * stepsTime); // Mbit/s
+      station.lastPower = station.energy / stepsTime; // potência média transmitida
+      station.lastAirtime = station.time / stepsTime; // fração do tempo ocupada pelo AP com a STA
+      if (station.node != 0)
+        {
+          Vector pos = GetPosition (station.node);
+          os << Simulator::Now ().GetSeconds () << "," << m_apNode->GetId () << "," << station.node->GetId ()
+             << "," << pos.x << "," << pos.y << "," << station.lastThroughput
+             << "," << station.lastPower << "," << station.lastAirtime << "\n";
+        }
+      station.bytes = 0;
+      station.energy = 0;
+      station.time = 0;
+    }
+  if (m_series != 0)
+    {
+      const Station &first = m_stations[0]; // o broadcast, se o AP não tiver STAs
+      Vector pos = first.node != 0 ? GetPosition (first.node) : Vector ();
+      SeriesRow row;
+      row.time = Simulator::Now ().GetSeconds ();
+      row.ap = m_apIndex;
+      row.x = pos.x;
+      row.y = pos.y;
+      row.throughput = ((bytesTotal * 8.0) / (1000000 * stepsTime)); // cálculo de mbs
+      row.averagePower = totalEnergy / stepsTime; // average transmission power (atp)
+      row.rate = m_table->dataRates[first.mode] / 1e6;
+      row.power = first.power;
+      m_series->Append (row);
+    }
+}
+
+// Resultado do último passo concluído para a estação 'station'
+void
+NodeStatistics::GetLastSample (uint32_t station, double &throughput, double &power, double &airtime) const
+{
+  throughput = m_stations[station].lastThroughput;
+  power = m_stations[station].lastPower;
+  airtime = m_stations[station].lastAirtime;
+}
+
+// Bytes recebidos pela estação 'station' desde o início do passo atual
+uint64_t
+NodeStatistics::GetStepBytes (uint32_t station) const
+{
+  return m_stations[station].bytes;
+}
+
+// Liga as estatísticas do AP 'ap' à série temporal
+void
+NodeStatistics::SetSeries (SeriesWriter *series, uint32_t ap)
+{
+  m_series = series;
+  m_apIndex = ap;
+}
+
+// Quantidade de STAs associadas ao AP (sem contar o endereço de broadcast)
+uint32_t
+NodeStatistics::GetNStations (void) const
+{
+  return m_stations.size () - 1;
+}
+
+// Pontos de medição de um levantamento ("survey"), percorridos em uma única simulação
+struct Survey
+{
+  std::vector<Vector> points; // posições da primeira STA
+  uint32_t next; // ponto em medição
+  std::ofstream output; // uma linha por ponto
+};
+
+// Lê o arquivo de pontos: uma posição "x y [z]" por linha; linhas vazias ou iniciadas
+// por '#' são ignoradas
+static std::vector<Vector>
+ReadSurveyPoints (const std::string &fileName)
+{
+  std::ifstream input (fileName.c_str ());
+  if (!input.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open survey file " << fileName);
+    }
+  std::vector<Vector> points;
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline (input, line))
+    {
+      lineNumber++;
+      std::string::size_type first = line.find_first_not_of (" \t\r");
+      if (first == std::string::npos || line[first] == '#')
+        {
+          continue;
+        }
+      std::istringstream iss (line);
+      Vector point (0.0, 0.0, 0.0);
+      if (!(iss >> point.x >> point.y))
+        {
+          NS_FATAL_ERROR (fileName << ":" << lineNumber << ": expected \"x y [z]\"");
+        }
+      iss >> point.z;
+      points.push_back (point);
+    }
+  return points;
+}
+
+// Estado compartilhado pelos passos de uma simulação
+struct StepContext
+{
+  std::vector<NodeStatistics *> statistics; // um por AP
+  NodeContainer stas;
+  double stepsSize;
+  uint32_t stepsTime; // duração (máxima, no modo adaptativo) de cada passo
+  std::ostream *pairs; // uma linha por par (AP, STA) a cada passo
+  Survey *survey; // nulo fora do modo de levantamento
+  std::vector<double> *samples; // vazão e potência de cada par a cada passo
+  // Passos adaptativos (convergenceTarget > 0): cada passo termina assim que a vazão de
+  // todos os pares estiver estacionária e com a precisão pedida
+  double convergenceTarget;
+  double batchTime; // duração de cada janela de amostragem (s)
+  uint32_t minBatches;
+  uint32_t steps; // quantidade de passos da simulação
+  uint32_t step; // passos concluídos
+  Time stepStart;
+  EventId stepEnd; // fim do passo por 'stepsTime'
+  EventId windowEvent; // próxima janela de amostragem
+  std::vector<std::vector<double> > windows; // bytes por janela de cada par no passo atual
+  std::vector<uint64_t> stepBytes; // bytes de cada par até a última janela
+  // Verificação do cache de propagação (checkCache): canal nulo sem verificação
+  Ptr<YansWifiChannel> cacheChannel;
+  std::size_t cacheLimit; // valores que o cache pode guardar
+  std::size_t cachePeakEntries;
+  std::size_t cachePeakKeys;
+};
+
+// Verifica que o cache de propagação do canal continua limitado e registra o seu pico
+static void
+CheckPropagationCache (StepContext *context)
+{
+  std::size_t entries;
+  std::size_t watchedKeys;
+  if (context->cacheChannel == 0 || !GetPropagationCacheSize (context->cacheChannel, entries, watchedKeys))
+    {
+      return;
+    }
+  if (entries > context->cacheLimit || watchedKeys > 2 * entries)
+    {
+      NS_FATAL_ERROR ("Propagation cache is not bounded at " << Simulator::Now ().GetSeconds () << " s: "
+                      << entries << " entries (limit " << context->cacheLimit << "), "
+                      << watchedKeys << " watched keys");
+    }
+  context->cachePeakEntries = std::max (context->cachePeakEntries, entries);
+  context->cachePeakKeys = std::max (context->cachePeakKeys, watchedKeys);
+}
+
+static void AdvancePositions (StepContext *context);
+
+// Janela de amostragem de um passo adaptativo: acrescenta os bytes recebidos por cada par
+// desde a janela anterior e encerra o passo quando todas as séries convergirem
+static void
+SampleWindow (StepContext *context)
+{
+  bool converged = true;
+  uint32_t pair = 0;
+  for (uint32_t j = 0; j < context->statistics.size (); j++)
+    {
+      for (uint32_t k = 0; k < context->statistics[j]->GetNStations (); k++, pair++)
+        {
+          uint64_t bytes = context->statistics[j]->GetStepBytes (k);
+          context->windows[pair].push_back (bytes - context->stepBytes[pair]);
+          context->stepBytes[pair] = bytes;
+          double mean;
+          converged = converged && IsSteadyState (context->windows[pair], context->convergenceTarget, context->minBatches, mean);
+        }
+    }
+  if (converged)
+    {
+      Simulator::Cancel (context->stepEnd);
+      AdvancePositions (context);
+      return;
+    }
+  context->windowEvent = Simulator::Schedule (Seconds (context->batchTime), &SampleWindow, context);
+}
+
+// Início de um passo adaptativo, limitado a 'stepsTime'
+static void
+StartStep (StepContext *context)
+{
+  uint32_t pairs = 0;
+  for (uint32_t j = 0; j < context->statistics.size (); j++)
+    {
+      pairs += context->statistics[j]->GetNStations ();
+    }
+  context->windows.assign (pairs, std::vector<double> ());
+  context->stepBytes.assign (pairs, 0);
+  context->stepStart = Simulator::Now ();
+  context->windowEvent = Simulator::Schedule (Seconds (context->batchTime), &SampleWindow, context);
+  context->stepEnd = Simulator::Schedule (Seconds (context->stepsTime), &AdvancePositions, context);
+}
+
+// Agenda o fim do próximo passo: após 'stepsTime' ou, no modo adaptativo, na convergência
+static void
+ScheduleStep (StepContext *context)
+{
+  if (context->convergenceTarget > 0)
+    {
+      StartStep (context);
+    }
+  else
+    {
+      Simulator::Schedule (Seconds (context->stepsTime), &AdvancePositions, context);
+    }
 }
 
-// Chamada de Gnuplot para o conjunto de dados quando utilizado.
-Gnuplot2dDataset
-NodeStatistics::GetDatafile ()
+// Ao fim de cada passo registra as estatísticas de todos os APs e desloca todas as STAs.
+// No modo de levantamento, grava o resultado do ponto atual e leva a primeira STA
+// diretamente ao próximo ponto; a simulação dos pontos termina com o último deles.
+static void
+AdvancePositions (StepContext *context)
 {
-  return m_output;
+  CheckPropagationCache (context);
+  std::vector<NodeStatistics *> &statistics = context->statistics;
+  double duration = context->stepsTime;
+  if (context->convergenceTarget > 0)
+    {
+      // A vazão e a potência do passo são médias sobre a sua duração efetiva
+      Simulator::Cancel (context->windowEvent);
+      duration = (Simulator::Now () - context->stepStart).GetSeconds ();
+      if (++context->step == context->steps)
+        {
+          Simulator::Stop ();
+        }
+    }
+  for (uint32_t j = 0; j < statistics.size (); j++)
+    {
+      statistics[j]->Sample (duration, *context->pairs);
+      for (uint32_t k = 0; k < statistics[j]->GetNStations (); k++)
+        {
+          double mbs, atp, airtime;
+          statistics[j]->GetLastSample (k, mbs, atp, airtime);
+          context->samples->push_back (mbs);
+          context->samples->push_back (atp);
+        }
+    }
+  Survey *survey = context->survey;
+  if (survey != 0)
+    {
+      const Vector &point = survey->points[survey->next];
+      double mbs, atp, airtime;
+      statistics[0]->GetLastSample (0, mbs, atp, airtime);
+      survey->output << survey->next << "," << point.x << "," << point.y << "," << point.z
+                     << "," << mbs << "," << atp << "," << airtime << "\n";
+      survey->next++;
+      if (survey->next == survey->points.size ())
+        {
+          return;
+        }
+      SetPosition (context->stas.Get (0), survey->points[survey->next]);
+      NS_LOG_INFO ("No intervalo de " << Simulator::Now ().GetSeconds () << " segundos; STA 0 no ponto " << survey->next << ": " << survey->points[survey->next]);
+      ScheduleStep (context);
+      return;
+    }
+// A posição de cada nó é incrementada com base no tamanho do passo (stepsSize)
+// Para realizar medições ponto a ponto, um de cada vez, será utilizado 1 passo apenas.
+  for (uint32_t j = 0; j < context->stas.GetN (); j++)
+    {
+      Vector pos = GetPosition (context->stas.Get (j));
+      pos.x += context->stepsSize;
+      SetPosition (context->stas.Get (j), pos);
+      NS_LOG_INFO ("No intervalo de " << Simulator::Now ().GetSeconds () << " segundos; configurando nova posição da STA " << j << " para " << pos);
+    }
+  ScheduleStep (context);
 }
 
-Gnuplot2dDataset
-NodeStatistics::GetPowerDatafile ()
+// Parâmetros de um cenário, definidos pela linha de comando
+struct ScenarioConfig
+{
+  uint32_t packetSize; // tamanho do pacote gerado no AP (bytes)
+  double maxPower; // valor máximo de potência
+  double minPower; // valor mínimo de potência
+  uint32_t powerLevels; // níveis de potência
+  uint32_t rtsThreshold;
+  std::string manager; // algoritmo de controle de potência e taxa do AP
+  std::string outputFileName; // nome do arquivo salvo
+  uint32_t nAps; // quantidade de APs
+  uint32_t nStas; // quantidade de STAs
+  double ap1_x; // posição 'x' do primeiro AP
+  double ap1_y; // posição 'y' do primeiro AP
+  double apSpacing; // distância entre APs vizinhos, ao longo de 'x' (m)
+  double sta1_x; // posição 'x' para STA, relativa ao seu AP
+  double sta1_y; // posição 'y' para STA, relativa ao seu AP
+  double staSpacing; // distância entre STAs do mesmo AP, ao longo de 'y' (m)
+  uint32_t steps; // quantidade de passos
+  double stepsSize; // tamanho do passo
+  uint32_t stepsTime; // tempo para cada passo
+  std::vector<Vector> surveyPoints; // pontos do levantamento (vazio fora desse modo)
+  bool cachePropagation; // memoriza perda e atraso de propagação até o próximo movimento
+  bool checkCache; // verifica a cada passo que o cache de propagação continua limitado
+  bool indexedChannel; // canal com índice espacial, que descarta recepções abaixo do piso
+  double rxPowerFloor; // piso de potência recebida do canal indexado [dBm]
+  bool profile; // imprime o perfil de execução de cada simulação
+  std::string profileFile; // arquivo com o perfil de cada simulação em JSON
+  double convergenceTarget; // erro relativo que encerra cada passo (0 = passos de duração fixa)
+  double batchTime; // duração das janelas de amostragem dos passos adaptativos (s)
+  uint32_t minBatches; // quantidade mínima de lotes antes de encerrar um passo
+};
+
+// Encaminha a recepção de uma STA para as estatísticas do seu AP
+static void
+StationRx (NodeStatistics *statistics, uint32_t station, Ptr<const Packet> packet, const Address &from)
 {
-  return m_output_power;
+  statistics->RxCallback (station, packet);
 }
 
 // Informações de Log para Potência e Vazão durante a simulação.
@@ -313,56 +920,119 @@ void RateCallback (std::string path, DataRate oldRate, DataRate newRate, Mac48Ad
   NS_LOG_INFO ((Simulator::Now ()).GetSeconds () << " " << dest << " Throughput anterior=" << oldRate << " Nova throughput=" <<  newRate);
 }
 
-// Função principal
-int main (int argc, char *argv[])
+// Verdadeiro para os gerenciadores que também adaptam a potência de transmissão
+static bool
+IsPowerManager (const std::string &manager)
 {
-  double maxPower = -40; // valor máximo de potência
-  double minPower = -70; // valor mínimo de potência
-  uint32_t powerLevels = 30; // níveis de potência
-  uint32_t rtsThreshold = 2346;
-  std::string manager = "ns3::ParfWifiManager"; // PARF Rate control algorithm
-  std::string outputFileName = "COMODO01_POSICAO01"; // nome do arquivo salvo
-  int ap1_x = 0; // posição 'x' do AP
-  int ap1_y = 0; // posição 'y' do AP
-  int sta1_x = -1.4; // posição 'x' para STA
-  int sta1_y = 3.0; // posição 'y' para STA
-  uint32_t steps = 1; // quantidade de passos
-  uint32_t stepsSize = 0.1; // tamanho do passo (mínimo para não interferir na posição atual)
-  uint32_t stepsTime = 1; // tempo para cada passo
+  return manager.compare ("ns3::ParfWifiManager") == 0
+         || manager.compare ("ns3::AparfWifiManager") == 0
+         || manager.compare ("ns3::RrpaaWifiManager") == 0;
+}
 
-// Caso não haja uma quantidade de passos definidas, a simulação é interrompida.
-  if (steps == 0)
+// Gera os arquivos com os dados para utilizar o gnuplot a partir da série temporal
+// 'seriesFile', depois da simulação: um conjunto por AP. O gráfico de potência só é
+// gerado se 'power'.
+static void
+WriteGnuplotFiles (const std::string &seriesFile, const std::string &outputFileName, bool power)
+{
+  std::vector<Gnuplot2dDataset> throughput;
+  std::vector<Gnuplot2dDataset> averagePower;
+  SeriesReader reader (seriesFile);
+  SeriesRow row;
+  while (reader.Next (row))
     {
-      std::cout << "Finalizando sem executar a simulação; steps = 0" << std::endl;
+      while (throughput.size () <= row.ap)
+        {
+          // Vazão (Mbps) e Potência Média (W)
+          throughput.push_back (Gnuplot2dDataset ("Throughput [Mbits/s]"));
+          averagePower.push_back (Gnuplot2dDataset ("Potência Transmitida [W]"));
+        }
+      throughput[row.ap].Add (row.x, row.throughput);
+      averagePower[row.ap].Add (row.x, row.averagePower);
+    }
+
+  std::ofstream outfile (("throughput-" + outputFileName + ".plt").c_str ());
+  Gnuplot gnuplot = Gnuplot (("throughput-" + outputFileName + ".eps").c_str (), "Throughput");
+  gnuplot.SetTerminal ("post eps color enhanced");
+  gnuplot.SetLegend ("Tempo (segundos)", "Throughput (Mb/s)");
+  gnuplot.SetTitle ("Throughput (AP -> STA) em função do tempo");
+  for (uint32_t j = 0; j < throughput.size (); j++)
+    {
+      gnuplot.AddDataset (throughput[j]);
+    }
+  gnuplot.GenerateOutput (outfile);
+
+  if (power)
+    {
+      std::ofstream outfile2 (("power-" + outputFileName + ".plt").c_str ());
+      gnuplot = Gnuplot (("power-" + outputFileName + ".eps").c_str (), "Potência transmitida");
+      gnuplot.SetTerminal ("post eps color enhanced");
+      gnuplot.SetLegend ("Tempo (segundos)", "Potência (W)");
+      gnuplot.SetTitle ("Potência Média de Transmissão (AP -> STA) em função do tempo");
+      for (uint32_t j = 0; j < averagePower.size (); j++)
+        {
+          gnuplot.AddDataset (averagePower[j]);
+        }
+      gnuplot.GenerateOutput (outfile2);
+    }
+}
+
+// Executa uma simulação completa do cenário, acrescentando a 'samples' a vazão e a potência
+// média de cada par (AP, STA) a cada passo. Com 'writeOutputs', grava também os arquivos
+// por par, do levantamento, da série temporal e, a partir desta, do gnuplot.
+static void
+RunScenario (const ScenarioConfig &config, bool writeOutputs, std::vector<double> &samples)
+{
+  bool profiling = config.profile || !config.profileFile.empty ();
+  std::ostringstream label;
+  label << "run=" << RngSeedManager::GetRun ();
+  RunProfiler profiler (label.str ());
+  if (profiling)
+    {
+      profiler.StartPhase ("setup");
     }
 
 // Definição do tempo de simulação a partir da quantidade de passos e sua duração.
-  uint32_t simuTime = (steps + 1) * stepsTime;
+  uint32_t simuTime = (config.steps + 1) * config.stepsTime;
 
-  // Define o AP utilizando a classe NodeContainer, que contém todas as propriedades pertinentes
+  // Define os APs utilizando a classe NodeContainer, que contém todas as propriedades pertinentes
   NodeContainer wifiApNodes;
-  wifiApNodes.Create (1);
+  wifiApNodes.Create (config.nAps);
 
-  // Define o STA da mesma forma que o AP
+  // Define as STAs da mesma forma que os APs
   NodeContainer wifiStaNodes;
-  wifiStaNodes.Create (1);
+  wifiStaNodes.Create (config.nStas);
 
   // Configuração do WiFi
   WifiHelper wifi; // classe para criar e configurar objetivos WiFi necessários aos WifiNetDevices
   wifi.SetStandard (WIFI_PHY_STANDARD_80211a); // configura o padrão utilizado: 802.11n
   WifiMacHelper wifiMac; // classe para configurar e instalar os objetos de WifiMac nos nós da rede
 // Configurações da camada PHY e do canal utilizado: classes WifiPhy e WifiChannel
-  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiPhyHelper wifiPhy = config.indexedChannel ? IndexedYansWifiPhyHelper::Default () : YansWifiPhyHelper::Default ();
   YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default ();
-// Criação do canal
-  wifiPhy.SetChannel (wifiChannel.Create ());
+// Criação do canal: a perda de cada par só é recalculada quando um dos nós se move
+  Ptr<YansWifiChannel> channel = config.indexedChannel ? CreateIndexedChannel (wifiChannel, config.rxPowerFloor) : wifiChannel.Create ();
+  if (config.cachePropagation)
+    {
+      EnablePropagationCache (channel);
+    }
+  wifiPhy.SetChannel (channel);
 
 // Instancia os dispositivos com suas propriedades: AP e STA
   NetDeviceContainer wifiApDevices;
   NetDeviceContainer wifiStaDevices;
   NetDeviceContainer wifiDevices;
 
-  // Configura o nó STA
+// Cada AP anuncia seu próprio SSID; a STA 's' associa-se ao AP 's % nAps'
+  std::vector<Ssid> ssids;
+  for (uint32_t j = 0; j < config.nAps; j++)
+    {
+      std::ostringstream oss;
+      oss << "AP" << j;
+      ssids.push_back (Ssid (oss.str ()));
+    }
+
+  // Configura os nós STA
 /* Configuração do RemoteStationManager para o RTS/CTS Threshold.
    Os roteadores e APs apresentam o gerenciamento ou manipulação dos pacotes na rede.
    Desta forma, as funções RTS (Request To Send) e CTS (Clear To Send) controlam
@@ -371,48 +1041,127 @@ int main (int argc, char *argv[])
    Utilizar o modo Threshold permite administrar quais pacotes acima do tamanho limite (threshold)
    são anunciados.
 */
-  wifi.SetRemoteStationManager ("ns3::MinstrelWifiManager", "RtsCtsThreshold", UintegerValue (rtsThreshold));
-  wifiPhy.Set ("TxPowerStart", DoubleValue (maxPower)); // potência de transmissão
-  wifiPhy.Set ("TxPowerEnd", DoubleValue (maxPower));
+  wifi.SetRemoteStationManager ("ns3::MinstrelWifiManager", "RtsCtsThreshold", UintegerValue (config.rtsThreshold));
+  wifiPhy.Set ("TxPowerStart", DoubleValue (config.maxPower)); // potência de transmissão
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (config.maxPower));
 
-  Ssid ssid = Ssid ("AP"); // SSID para o AP
-  wifiMac.SetType ("ns3::StaWifiMac",
-                   "Ssid", SsidValue (ssid));
-  wifiStaDevices.Add (wifi.Install (wifiPhy, wifiMac, wifiStaNodes.Get (0)));
+  std::vector<NetDeviceContainer> apStaDevices (config.nAps); // STAs associadas a cada AP
+  for (uint32_t s = 0; s < config.nStas; s++)
+    {
+      wifiMac.SetType ("ns3::StaWifiMac",
+                       "Ssid", SsidValue (ssids[s % config.nAps]));
+      NetDeviceContainer device = wifi.Install (wifiPhy, wifiMac, wifiStaNodes.Get (s));
+      wifiStaDevices.Add (device);
+      apStaDevices[s % config.nAps].Add (device);
+    }
 
-  // Configura o nó AP
+  // Configura os nós AP
   // Configura o Threshold e os níveis de potência de maneira semelhante ao STA
-  wifi.SetRemoteStationManager (manager, "DefaultTxPowerLevel", UintegerValue (powerLevels - 1), "RtsCtsThreshold", UintegerValue (rtsThreshold));
-  wifiPhy.Set ("TxPowerStart", DoubleValue (minPower));
-  wifiPhy.Set ("TxPowerEnd", DoubleValue (maxPower));
-  wifiPhy.Set ("TxPowerLevels", UintegerValue (powerLevels));
+  wifi.SetRemoteStationManager (config.manager, "DefaultTxPowerLevel", UintegerValue (config.powerLevels - 1), "RtsCtsThreshold", UintegerValue (config.rtsThreshold));
+  wifiPhy.Set ("TxPowerStart", DoubleValue (config.minPower));
+  wifiPhy.Set ("TxPowerEnd", DoubleValue (config.maxPower));
+  wifiPhy.Set ("TxPowerLevels", UintegerValue (config.powerLevels));
 
-  ssid = Ssid ("AP"); // SSID para o AP
-  wifiMac.SetType ("ns3::ApWifiMac",
-                   "Ssid", SsidValue (ssid));
-  wifiApDevices.Add (wifi.Install (wifiPhy, wifiMac, wifiApNodes.Get (0)));
+  for (uint32_t j = 0; j < config.nAps; j++)
+    {
+      wifiMac.SetType ("ns3::ApWifiMac",
+                       "Ssid", SsidValue (ssids[j]));
+      wifiApDevices.Add (wifi.Install (wifiPhy, wifiMac, wifiApNodes.Get (j)));
+    }
 
-  wifiDevices.Add (wifiStaDevices); // adiciona o nó STA
-  wifiDevices.Add (wifiApDevices); // adiciona o nó AP
+  wifiDevices.Add (wifiStaDevices); // adiciona os nós STA
+  wifiDevices.Add (wifiApDevices); // adiciona os nós AP
 
   // Configuração do esquema de mobilidade
   MobilityHelper mobility;
   Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> (); // alocação de posição
-  positionAlloc->Add (Vector (ap1_x, ap1_y, 0.0)); // Posições iniciais AP
-  NS_LOG_INFO ("Setting initial AP position to " << Vector (ap1_x, ap1_y, 0.0));
-  positionAlloc->Add (Vector (sta1_x, sta1_y, 0.0)); // Posições iniciais STA
-  NS_LOG_INFO ("Setting initial STA position to " << Vector (sta1_x, sta1_y, 0.0));
+  for (uint32_t j = 0; j < config.nAps; j++)
+    {
+      Vector apPosition (config.ap1_x + j * config.apSpacing, config.ap1_y, 0.0);
+      positionAlloc->Add (apPosition); // Posições iniciais AP
+      NS_LOG_INFO ("Setting initial AP " << j << " position to " << apPosition);
+    }
+  for (uint32_t s = 0; s < config.nStas; s++)
+    {
+      Vector staPosition (config.ap1_x + (s % config.nAps) * config.apSpacing + config.sta1_x, config.ap1_y + config.sta1_y + (s / config.nAps) * config.staSpacing, 0.0);
+      if (s == 0 && !config.surveyPoints.empty ())
+        {
+          staPosition = config.surveyPoints[0];
+        }
+      positionAlloc->Add (staPosition); // Posições iniciais STA
+      NS_LOG_INFO ("Setting initial STA " << s << " position to " << staPosition);
+    }
   mobility.SetPositionAllocator (positionAlloc);
   // Modelo em que a posição atual não é alterada quando já foi configurada a não ser que seja reconfigurada
   mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-  mobility.Install (wifiApNodes.Get (0));
-  mobility.Install (wifiStaNodes.Get (0));
+  mobility.Install (wifiApNodes);
+  mobility.Install (wifiStaNodes);
+
+  // Statistics counter: um por AP, com as STAs associadas a ele
+  std::vector<NodeStatistics *> statistics;
+  for (uint32_t j = 0; j < config.nAps; j++)
+    {
+      statistics.push_back (new NodeStatistics (NetDeviceContainer (wifiApDevices.Get (j)), apStaDevices[j],
+                                                config.packetSize));
+    }
+
+  // Estatísticas por par (AP, STA) a cada passo; sem arquivos de saída, as linhas são
+  // descartadas por um stream sem buffer
+  std::ofstream pairsFile;
+  std::ostream discard (0);
+  if (writeOutputs)
+    {
+      pairsFile.open (("pairs-" + config.outputFileName + ".csv").c_str ());
+      pairsFile << "time,apNode,staNode,staX,staY,throughput,averagePower,airtime\n";
+    }
+
+  // Série temporal de cada AP, gravada em disco a cada bloco de linhas
+  std::string seriesFile = "series-" + config.outputFileName + ".bin";
+  SeriesWriter *series = 0;
+  if (writeOutputs)
+    {
+      series = new SeriesWriter (seriesFile, 1024);
+      for (uint32_t j = 0; j < config.nAps; j++)
+        {
+          statistics[j]->SetSeries (series, j);
+        }
+    }
 
-  // Statistics counter
-  NodeStatistics statistics = NodeStatistics (wifiApDevices, wifiStaDevices);
+  // Resultado de cada ponto do levantamento
+  Survey survey;
+  survey.points = config.surveyPoints;
+  survey.next = 0;
+  if (writeOutputs && !survey.points.empty ())
+    {
+      survey.output.open (("survey-" + config.outputFileName + ".csv").c_str ());
+      survey.output << "point,x,y,z,throughput,averagePower,airtime\n";
+    }
 
-  // Configura a posição de STA de acordo com 'stepSize' (metros) a cada 'stepsTime' (segundos)
-  Simulator::Schedule (Seconds (0.5 + stepsTime), &NodeStatistics::AdvancePosition, &statistics, wifiStaNodes.Get (0), stepsSize, stepsTime);
+  // Configura a posição das STAs de acordo com 'stepSize' (metros) a cada 'stepsTime' (segundos)
+  StepContext context;
+  context.statistics = statistics;
+  context.stas = wifiStaNodes;
+  context.stepsSize = config.stepsSize;
+  context.stepsTime = config.stepsTime;
+  context.pairs = writeOutputs ? static_cast<std::ostream *> (&pairsFile) : &discard;
+  context.survey = survey.points.empty () ? 0 : &survey;
+  context.samples = &samples;
+  context.convergenceTarget = config.convergenceTarget;
+  context.batchTime = config.batchTime;
+  context.minBatches = config.minBatches;
+  context.steps = config.steps;
+  context.step = 0;
+  // Perda: um valor por par ordenado de nós e potência de transmissão (níveis do AP e
+  // potência da STA); atraso: um valor por par ordenado
+  std::size_t nodes = config.nAps + config.nStas;
+  if (config.cachePropagation && config.checkCache)
+    {
+      context.cacheChannel = channel;
+    }
+  context.cacheLimit = nodes * nodes * (config.powerLevels + 2);
+  context.cachePeakEntries = 0;
+  context.cachePeakKeys = 0;
+  Simulator::Schedule (Seconds (0.5), &ScheduleStep, &context);
 
   // Configura pilha de protocolos IP
   // A classe InternetStackHelper agrega funcionalidades IP/TCP/UDP aos nós 
@@ -420,71 +1169,472 @@ int main (int argc, char *argv[])
   stack.Install (wifiApNodes);
   stack.Install (wifiStaNodes);
   Ipv4AddressHelper address;
-  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.SetBase ("10.1.0.0", "255.255.0.0");
   Ipv4InterfaceContainer i = address.Assign (wifiDevices);
-  Ipv4Address sinkAddress = i.GetAddress (0);
   uint16_t port = 9;
 
-  // Configure the CBR generator
-  PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (sinkAddress, port));
-  ApplicationContainer apps_sink = sink.Install (wifiStaNodes.Get (0));
+  // Configure the CBR generator: um fluxo de cada AP para cada uma de suas STAs
+  for (uint32_t s = 0; s < config.nStas; s++)
+    {
+      Ipv4Address sinkAddress = i.GetAddress (s);
+      PacketSinkHelper sink ("ns3::UdpSocketFactory", InetSocketAddress (sinkAddress, port));
+      ApplicationContainer apps_sink = sink.Install (wifiStaNodes.Get (s));
+
+      OnOffHelper onoff ("ns3::UdpSocketFactory", InetSocketAddress (sinkAddress, port));
+      onoff.SetConstantRate (DataRate ("54Mb/s"), config.packetSize);
+      onoff.SetAttribute ("StartTime", TimeValue (Seconds (0.5)));
+      onoff.SetAttribute ("StopTime", TimeValue (Seconds (simuTime)));
+      onoff.Install (wifiApNodes.Get (s % config.nAps));
 
-  OnOffHelper onoff ("ns3::UdpSocketFactory", InetSocketAddress (sinkAddress, port));
-  onoff.SetConstantRate (DataRate ("54Mb/s"), packetSize);
-  onoff.SetAttribute ("StartTime", TimeValue (Seconds (0.5)));
-  onoff.SetAttribute ("StopTime", TimeValue (Seconds (simuTime)));
-  ApplicationContainer apps_source = onoff.Install (wifiApNodes.Get (0));
+      apps_sink.Start (Seconds (0.5));
+      apps_sink.Stop (Seconds (simuTime));
 
-  apps_sink.Start (Seconds (0.5));
-  apps_sink.Stop (Seconds (simuTime));
+      // Registro de pacotes recebidos para calcular a Vazão/Throughput do par
+      apps_sink.Get (0)->TraceConnectWithoutContext ("Rx", MakeBoundCallback (&StationRx, statistics[s % config.nAps], s / config.nAps));
+    }
 
   // Registros de dados
+  for (uint32_t j = 0; j < config.nAps; j++)
+    {
+      std::ostringstream oss;
+      oss << "/NodeList/" << wifiApNodes.Get (j)->GetId () << "/DeviceList/*/$ns3::WifiNetDevice/";
+      std::string apPath = oss.str ();
 
-  // Registro de pacotes recebidos para calcular a Vazão/Throughput
-  Config::Connect ("/NodeList/1/ApplicationList/*/$ns3::PacketSink/Rx",
-                   MakeCallback (&NodeStatistics::RxCallback, &statistics));
-
-  // Registro de Potência e Intervalo de tempo para calcular a Potência Média Transmitida
-  Config::Connect ("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/$" + manager + "/PowerChange",
-                   MakeCallback (&NodeStatistics::PowerCallback, &statistics));
-  Config::Connect ("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/$" + manager + "/RateChange",
-                   MakeCallback (&NodeStatistics::RateCallback, &statistics));
+      // Registro de Potência e Intervalo de tempo para calcular a Potência Média Transmitida
+      Config::Connect (apPath + "RemoteStationManager/$" + config.manager + "/PowerChange",
+                       MakeCallback (&NodeStatistics::PowerCallback, statistics[j]));
+      Config::Connect (apPath + "RemoteStationManager/$" + config.manager + "/RateChange",
+                       MakeCallback (&NodeStatistics::RateCallback, statistics[j]));
 
-  Config::Connect ("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxBegin",
-                   MakeCallback (&NodeStatistics::PhyCallback, &statistics));
+      Config::Connect (apPath + "Phy/PhyTxBegin",
+                       MakeCallback (&NodeStatistics::PhyCallback, statistics[j]));
 
-  // Chamado para registrar cada mudança de Potência e Tempo
-  Config::Connect ("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/$" + manager + "/PowerChange",
-                   MakeCallback (PowerCallback));
-  Config::Connect ("/NodeList/0/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/$" + manager + "/RateChange",
-                   MakeCallback (RateCallback));
+      // Chamado para registrar cada mudança de Potência e Tempo
+      Config::Connect (apPath + "RemoteStationManager/$" + config.manager + "/PowerChange",
+                       MakeCallback (PowerCallback));
+      Config::Connect (apPath + "RemoteStationManager/$" + config.manager + "/RateChange",
+                       MakeCallback (RateCallback));
+    }
 
   Simulator::Stop (Seconds (simuTime));
+  if (profiling)
+    {
+      profiler.StartPhase ("run");
+    }
   Simulator::Run ();
 
-  // Gera os arquivos com os dados para utilizar o gnuplot se desejado
-  std::ofstream outfile (("throughput-" + outputFileName + ".plt").c_str ());
-  Gnuplot gnuplot = Gnuplot (("throughput-" + outputFileName + ".eps").c_str (), "Throughput");
-  gnuplot.SetTerminal ("post eps color enhanced");
-  gnuplot.SetLegend ("Tempo (segundos)", "Throughput (Mb/s)");
-  gnuplot.SetTitle ("Throughput (AP -> STA) em função do tempo");
-  gnuplot.AddDataset (statistics.GetDatafile ());
-  gnuplot.GenerateOutput (outfile);
-
-  if (manager.compare ("ns3::ParfWifiManager") == 0
-      || manager.compare ("ns3::AparfWifiManager") == 0
-      || manager.compare ("ns3::RrpaaWifiManager") == 0)
+  if (profiling)
     {
-      std::ofstream outfile2 (("power-" + outputFileName + ".plt").c_str ());
-      gnuplot = Gnuplot (("power-" + outputFileName + ".eps").c_str (), "Potência transmitida");
-      gnuplot.SetTerminal ("post eps color enhanced");
-      gnuplot.SetLegend ("Tempo (segundos)", "Potência (W)");
-      gnuplot.SetTitle ("Potência Média de Transmissão (AP -> STA) em função do tempo");
-      gnuplot.AddDataset (statistics.GetPowerDatafile ());
-      gnuplot.GenerateOutput (outfile2);
+      profiler.StartPhase ("extract");
+    }
+  if (context.cacheChannel != 0)
+    {
+      std::cout << "Cache de propagação: pico de " << context.cachePeakEntries << " valores e "
+                << context.cachePeakKeys << " chaves observadas (limite de " << context.cacheLimit
+                << " valores)" << std::endl;
+    }
+  if (writeOutputs)
+    {
+      delete series;
+      WriteGnuplotFiles (seriesFile, config.outputFileName, IsPowerManager (config.manager));
+      Ptr<IndexedYansWifiChannel> indexed = DynamicCast<IndexedYansWifiChannel> (channel);
+      if (indexed != 0)
+        {
+          std::cout << "Canal indexado: " << indexed->GetScheduledReceptions () << " recepções agendadas, "
+                    << indexed->GetSkippedReceptions () << " descartadas" << std::endl;
+        }
     }
 
+  if (profiling)
+    {
+      profiler.StartPhase ("destroy");
+    }
   Simulator::Destroy ();
+  for (uint32_t j = 0; j < config.nAps; j++)
+    {
+      delete statistics[j];
+    }
+  if (profiling)
+    {
+      profiler.Stop ();
+      profiler.Report (config.profile, config.profileFile);
+    }
+}
+
+
+// Processo filho que executa uma replicação
+struct ReplicationWorker
+{
+  pid_t pid;
+  int fd; // leitura do pipe com as amostras
+  uint32_t replication;
+  std::string data;
+};
+
+// Verifica se todos os intervalos de confiança atingiram a semi-amplitude relativa 'ciTarget'
+static bool
+HasConverged (const std::vector<RunningStatistics> &accumulators, uint32_t minReplications, double ciTarget)
+{
+  if (ciTarget <= 0 || accumulators.empty () || accumulators[0].GetCount () < std::max<uint32_t> (minReplications, 2))
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < accumulators.size (); i++)
+    {
+      if (accumulators[i].GetHalfWidth () > ciTarget * std::abs (accumulators[i].GetMean ()))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+// Cria um processo filho que executa a replicação 'replication' (número de execução
+// 'baseRun + replication') e devolve as amostras pelo pipe
+static void
+StartReplicationWorker (const ScenarioConfig &config, uint32_t baseRun, uint32_t replication,
+                        std::vector<ReplicationWorker> &workers)
+{
+  int fds[2];
+  if (pipe (fds) != 0)
+    {
+      NS_FATAL_ERROR ("pipe () failed: " << std::strerror (errno));
+    }
+  std::cout.flush ();
+  pid_t pid = fork ();
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("fork () failed: " << std::strerror (errno));
+    }
+  if (pid == 0)
+    {
+      close (fds[0]);
+      RngSeedManager::SetRun (baseRun + replication);
+      std::vector<double> samples;
+      RunScenario (config, false, samples);
+      const char *data = reinterpret_cast<const char *> (samples.data ());
+      std::size_t size = samples.size () * sizeof (double);
+      while (size > 0)
+        {
+          ssize_t n = write (fds[1], data, size);
+          if (n < 0 && errno == EINTR)
+            {
+              continue;
+            }
+          if (n <= 0)
+            {
+              _exit (1);
+            }
+          data += n;
+          size -= n;
+        }
+      close (fds[1]);
+      _exit (0);
+    }
+  close (fds[1]);
+  ReplicationWorker worker;
+  worker.pid = pid;
+  worker.fd = fds[0];
+  worker.replication = replication;
+  workers.push_back (worker);
+}
+
+// Executa até 'maxReplications' replicações independentes do cenário, com no máximo
+// 'maxWorkers' processos simultâneos, e acumula cada amostra (vazão e potência de cada
+// par a cada passo) em 'accumulators'. As replicações são combinadas na ordem do número
+// de execução, de modo que o resultado não depende da ordem em que os processos
+// terminam; a execução para assim que todos os intervalos de confiança atingem
+// 'ciTarget'. Retorna a quantidade de replicações combinadas.
+static uint32_t
+RunReplications (const ScenarioConfig &config, uint32_t maxReplications, uint32_t minReplications,
+                 double ciTarget, uint32_t maxWorkers, std::vector<RunningStatistics> &accumulators)
+{
+  std::size_t nSamples = static_cast<std::size_t> (config.steps) * config.nStas * 2;
+  accumulators.assign (nSamples, RunningStatistics ());
+  uint32_t baseRun = RngSeedManager::GetRun ();
+
+  std::map<uint32_t, std::vector<double> > finished; // replicações concluídas fora de ordem
+  std::vector<ReplicationWorker> workers;
+  uint32_t next = 0; // próxima replicação a ser iniciada
+  uint32_t folded = 0; // replicações já combinadas
+  bool converged = false;
+  while (!converged && (next < maxReplications || !workers.empty ()))
+    {
+      if (maxWorkers <= 1)
+        {
+          RngSeedManager::SetRun (baseRun + next);
+          RunScenario (config, false, finished[next]);
+          next++;
+        }
+      else
+        {
+          while (next < maxReplications && workers.size () < maxWorkers)
+            {
+              StartReplicationWorker (config, baseRun, next, workers);
+              next++;
+            }
+
+          std::vector<struct pollfd> fds (workers.size ());
+          for (std::size_t i = 0; i < workers.size (); i++)
+            {
+              fds[i].fd = workers[i].fd;
+              fds[i].events = POLLIN;
+              fds[i].revents = 0;
+            }
+          if (poll (&fds[0], fds.size (), -1) < 0)
+            {
+              if (errno == EINTR)
+                {
+                  continue;
+                }
+              NS_FATAL_ERROR ("poll () failed: " << std::strerror (errno));
+            }
+
+          // Percorre de trás para frente para poder remover os filhos concluídos
+          for (std::size_t i = workers.size (); i-- > 0; )
+            {
+              if (fds[i].revents == 0)
+                {
+                  continue;
+                }
+              char buffer[4096];
+              ssize_t n = read (workers[i].fd, buffer, sizeof (buffer));
+              if (n > 0)
+                {
+                  workers[i].data.append (buffer, n);
+                  continue;
+                }
+              if (n < 0 && errno == EINTR)
+                {
+                  continue;
+                }
+              close (workers[i].fd);
+              int status = 0;
+              while (waitpid (workers[i].pid, &status, 0) < 0 && errno == EINTR)
+                {
+                }
+              if (!WIFEXITED (status) || WEXITSTATUS (status) != 0 || workers[i].data.size () != nSamples * sizeof (double))
+                {
+                  NS_FATAL_ERROR ("Replication " << workers[i].replication << " failed");
+                }
+              std::vector<double> &samples = finished[workers[i].replication];
+              samples.resize (nSamples);
+              std::memcpy (samples.data (), workers[i].data.data (), workers[i].data.size ());
+              workers.erase (workers.begin () + i);
+            }
+        }
+
+      // Combina as replicações concluídas em sequência
+      while (!converged && finished.count (folded) > 0)
+        {
+          std::vector<double> &samples = finished[folded];
+          NS_ABORT_MSG_UNLESS (samples.size () == nSamples, "Replication " << folded << " returned " << samples.size () << " samples");
+          for (std::size_t i = 0; i < nSamples; i++)
+            {
+              accumulators[i].Add (samples[i]);
+            }
+          finished.erase (folded);
+          folded++;
+          converged = HasConverged (accumulators, minReplications, ciTarget);
+        }
+    }
+
+  // Interrompe as replicações que se tornaram desnecessárias
+  for (std::size_t i = 0; i < workers.size (); i++)
+    {
+      kill (workers[i].pid, SIGKILL);
+      close (workers[i].fd);
+      while (waitpid (workers[i].pid, 0, 0) < 0 && errno == EINTR)
+        {
+        }
+    }
+  return folded;
+}
+
+// Grava a média e a semi-amplitude do intervalo de confiança de cada par (AP, STA) a cada passo
+static void
+WriteReplicationFile (const ScenarioConfig &config, const std::vector<RunningStatistics> &accumulators)
+{
+  std::ofstream output (("replications-" + config.outputFileName + ".csv").c_str ());
+  output << "step,ap,sta,replications,throughputMean,throughputHalfWidth,powerMean,powerHalfWidth\n";
+  std::size_t i = 0;
+  for (uint32_t step = 0; step < config.steps; step++)
+    {
+      // Mesma ordem de AdvancePositions: APs em sequência e, em cada AP, suas STAs
+      for (uint32_t j = 0; j < config.nAps; j++)
+        {
+          for (uint32_t s = j; s < config.nStas; s += config.nAps)
+            {
+              const RunningStatistics &mbs = accumulators[i++];
+              const RunningStatistics &atp = accumulators[i++];
+              output << step << "," << j << "," << s << "," << mbs.GetCount ()
+                     << "," << mbs.GetMean () << "," << mbs.GetHalfWidth ()
+                     << "," << atp.GetMean () << "," << atp.GetHalfWidth () << "\n";
+            }
+        }
+    }
+}
+
+// Função principal
+int main (int argc, char *argv[])
+{
+  uint32_t packetSize = defaultPacketSize; // tamanho do pacote gerado no AP (bytes)
+  double maxPower = -40; // valor máximo de potência
+  double minPower = -70; // valor mínimo de potência
+  uint32_t powerLevels = 30; // níveis de potência
+  uint32_t rtsThreshold = 2346;
+  std::string manager = "ns3::ParfWifiManager"; // PARF Rate control algorithm
+  std::string outputFileName = "COMODO01_POSICAO01"; // nome do arquivo salvo
+  uint32_t nAps = 1; // quantidade de APs
+  uint32_t nStas = 1; // quantidade de STAs
+  double ap1_x = 0; // posição 'x' do primeiro AP
+  double ap1_y = 0; // posição 'y' do primeiro AP
+  double apSpacing = 10; // distância entre APs vizinhos, ao longo de 'x' (m)
+  double sta1_x = -1.4; // posição 'x' para STA, relativa ao seu AP
+  double sta1_y = 3.0; // posição 'y' para STA, relativa ao seu AP
+  double staSpacing = 1; // distância entre STAs do mesmo AP, ao longo de 'y' (m)
+  uint32_t steps = 1; // quantidade de passos
+  double stepsSize = 0.1; // tamanho do passo (mínimo para não interferir na posição atual)
+  uint32_t stepsTime = 1; // tempo para cada passo
+  std::string surveyFile = ""; // arquivo com os pontos de medição percorridos pela primeira STA
+  std::string plotSeries = ""; // gera apenas os arquivos do gnuplot a partir desta série temporal
+  uint32_t replications = 1; // quantidade máxima de replicações independentes
+  uint32_t minReplications = 3; // quantidade mínima de replicações antes da parada antecipada
+  double ciTarget = 0; // semi-amplitude relativa do intervalo de confiança que encerra as replicações
+  uint32_t workers = 1; // replicações simuladas em paralelo
+  bool cachePropagation = true; // reaproveita a perda e o atraso de propagação entre os passos
+  bool checkCache = false; // verifica a cada passo que o cache de propagação continua limitado
+  bool indexedChannel = false; // agenda apenas as recepções acima de rxPowerFloor
+  double rxPowerFloor = -110; // piso de potência recebida do canal indexado [dBm]
+  bool profile = false; // imprime o perfil de execução de cada simulação
+  std::string profileFile = ""; // acrescenta o perfil de cada simulação em JSON a este arquivo
+  double convergenceTarget = 0; // erro relativo que encerra cada passo (0 = passos de duração fixa)
+  double batchTime = 0.05; // duração das janelas de amostragem dos passos adaptativos (s)
+  uint32_t minBatches = 10; // quantidade mínima de lotes antes de encerrar um passo
+
+
+  CommandLine cmd;
+  cmd.AddValue ("packetSize", "Size of the packets sent by the AP (bytes)", packetSize);
+  cmd.AddValue ("maxPower", "Maximum available transmission level (dbm)", maxPower);
+  cmd.AddValue ("minPower", "Minimum available transmission level (dbm)", minPower);
+  cmd.AddValue ("powerLevels", "Number of transmission power levels available between minPower and maxPower (inclusive)", powerLevels);
+  cmd.AddValue ("manager", "PRC Manager", manager);
+  cmd.AddValue ("rtsThreshold", "RTS threshold", rtsThreshold);
+  cmd.AddValue ("outputFileName", "Output filename", outputFileName);
+  cmd.AddValue ("nAps", "Number of APs, placed along the x axis", nAps);
+  cmd.AddValue ("nStas", "Number of STAs, associated with the APs in round-robin order", nStas);
+  cmd.AddValue ("AP1_x", "Position of the first AP in x coordinate", ap1_x);
+  cmd.AddValue ("AP1_y", "Position of the first AP in y coordinate", ap1_y);
+  cmd.AddValue ("apSpacing", "Distance between neighbouring APs (m)", apSpacing);
+  cmd.AddValue ("STA1_x", "Position of a STA in x coordinate, relative to its AP", sta1_x);
+  cmd.AddValue ("STA1_y", "Position of a STA in y coordinate, relative to its AP", sta1_y);
+  cmd.AddValue ("staSpacing", "Distance between STAs of the same AP (m)", staSpacing);
+  cmd.AddValue ("steps", "How many different distances to try", steps);
+  cmd.AddValue ("stepsSize", "Distance between steps", stepsSize);
+  cmd.AddValue ("stepsTime", "Time on each step", stepsTime);
+  cmd.AddValue ("surveyFile", "File of \"x y [z]\" survey points visited by the first STA, one per step, in a single run", surveyFile);
+  cmd.AddValue ("replications", "Maximum number of independent replications (RngRun, RngRun + 1, ...); 1 runs a single simulation with the usual output files", replications);
+  cmd.AddValue ("minReplications", "Minimum number of replications before stopping on ciTarget", minReplications);
+  cmd.AddValue ("ciTarget", "Stop the replications once every 95% confidence half-width is below this fraction of its mean (0 disables)", ciTarget);
+  cmd.AddValue ("workers", "Number of replications simulated in parallel processes (0 = number of CPUs)", workers);
+  cmd.AddValue ("cachePropagation", "Compute the propagation loss and delay of each node pair once and reuse them until a node moves", cachePropagation);
+  cmd.AddValue ("checkCache", "Check at every step that the propagation cache stays bounded while the STAs move, and print its peak size", checkCache);
+  cmd.AddValue ("indexedChannel", "Use a spatially indexed channel that only schedules receptions at or above rxPowerFloor", indexedChannel);
+  cmd.AddValue ("rxPowerFloor", "Lowest received power (dBm) scheduled by the indexed channel", rxPowerFloor);
+  cmd.AddValue ("profile", "Print the wall time per phase, event counts and process peak RSS after every simulation to standard error", profile);
+  cmd.AddValue ("profileFile", "if set, append the profile of every simulation to this file, one JSON object per line", profileFile);
+  cmd.AddValue ("convergenceTarget", "End each step once the throughput of every pair is steady and its 95% confidence half-width is below this fraction of the mean; stepsTime becomes the cap (0 = fixed steps)", convergenceTarget);
+  cmd.AddValue ("batchTime", "Sampling window of the adaptive steps (s)", batchTime);
+  cmd.AddValue ("minBatches", "Minimum number of batches before an adaptive step may end", minBatches);
+  cmd.AddValue ("plotSeries", "Only generate the gnuplot files of outputFileName from this series file and exit, without simulating", plotSeries);
+  cmd.Parse (argc, argv);
+
+  if (!plotSeries.empty ())
+    {
+      WriteGnuplotFiles (plotSeries, outputFileName, IsPowerManager (manager));
+      return 0;
+    }
+
+// Modo de levantamento: um passo por ponto do arquivo
+  std::vector<Vector> surveyPoints;
+  if (!surveyFile.empty ())
+    {
+      surveyPoints = ReadSurveyPoints (surveyFile);
+      if (surveyPoints.empty ())
+        {
+          std::cout << "Nenhum ponto em " << surveyFile << std::endl;
+          return 1;
+        }
+      steps = surveyPoints.size ();
+    }
+
+// Caso não haja uma quantidade de passos definidas, a simulação é interrompida.
+  if (steps == 0)
+    {
+      std::cout << "Finalizando sem executar a simulação; steps = 0" << std::endl;
+    }
+  if (nAps == 0 || nStas == 0)
+    {
+      std::cout << "nAps e nStas devem ser maiores que zero" << std::endl;
+      return 1;
+    }
+  if (convergenceTarget > 0 && (batchTime <= 0 || minBatches < 2))
+    {
+      std::cout << "batchTime deve ser maior que zero e minBatches ao menos 2" << std::endl;
+      return 1;
+    }
+
+
+  ScenarioConfig config;
+  config.packetSize = packetSize;
+  config.maxPower = maxPower;
+  config.minPower = minPower;
+  config.powerLevels = powerLevels;
+  config.rtsThreshold = rtsThreshold;
+  config.manager = manager;
+  config.outputFileName = outputFileName;
+  config.nAps = nAps;
+  config.nStas = nStas;
+  config.ap1_x = ap1_x;
+  config.ap1_y = ap1_y;
+  config.apSpacing = apSpacing;
+  config.sta1_x = sta1_x;
+  config.sta1_y = sta1_y;
+  config.staSpacing = staSpacing;
+  config.steps = steps;
+  config.stepsSize = stepsSize;
+  config.stepsTime = stepsTime;
+  config.surveyPoints = surveyPoints;
+  config.cachePropagation = cachePropagation;
+  config.checkCache = checkCache;
+  config.indexedChannel = indexedChannel;
+  config.rxPowerFloor = rxPowerFloor;
+  config.profile = profile;
+  config.profileFile = profileFile;
+  config.convergenceTarget = convergenceTarget;
+  config.batchTime = batchTime;
+  config.minBatches = minBatches;
+  if (profile || !profileFile.empty ())
+    {
+      RunProfiler::Enable ();
+    }
+
+  std::vector<double> samples;
+  if (replications <= 1)
+    {
+      RunScenario (config, true, samples);
+      return 0;
+    }
+
+// Replicações independentes: média e intervalo de confiança de cada amostra
+  if (workers == 0)
+    {
+      workers = std::max<long> (1, sysconf (_SC_NPROCESSORS_ONLN));
+    }
+  std::vector<RunningStatistics> accumulators;
+  uint32_t done = RunReplications (config, replications, minReplications, ciTarget, workers, accumulators);
+  WriteReplicationFile (config, accumulators);
+  std::cout << "Replicações: " << done << (HasConverged (accumulators, minReplications, ciTarget) ? " (intervalo de confiança atingido)" : " (limite de replicações)") << std::endl;
 
   return 0;
 }
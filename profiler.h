@@ -0,0 +1,646 @@
+/*
+## RESUMO ##
+
+Medição do tempo de parede e da taxa de eventos de cada execução, compartilhada por
+trabalho.cc, power-adaptation-distance.cc e wifi-simple-interference.cc.
+
+> ProfilingScheduler: escalonador do simulador que delega ao escalonador configurado
+em "SchedulerType" (MapScheduler, por padrão) e conta os eventos executados, no total
+e por tipo (classe do EventImpl, isto é, a assinatura da função agendada).
+RunProfiler::Enable () o instala para todas as instâncias do simulador criadas depois,
+por isso deve ser chamado logo após o CommandLine::Parse.
+> RunProfiler: divide uma execução em fases ("setup", "routing", "run", "extract",
+"destroy", ...) com StartPhase/Stop e registra, por fase, o tempo de parede e os
+eventos executados, além dos eventos por tipo, do pico de memória residente (RSS) do
+processo desde o seu início (getrusage, que não pode ser zerado: em um processo que faz
+várias simulações, o valor de cada uma inclui as anteriores), de eventos por segundo e, se contadas, das alocações feitas com o operator
+new. Report imprime um resumo em std::cerr e/ou acrescenta um objeto JSON por linha a um arquivo; cada saída é feita com uma única
+escrita, para que os processos paralelos das varreduras não se misturem.
+> Contagem de alocações (opcional): apenas quando o programa é compilado com
+PROFILER_COUNT_ALLOCATIONS definido (por exemplo, CXXFLAGS="-DPROFILER_COUNT_ALLOCATIONS"
+no ./waf configure), este cabeçalho substitui todas as formas do operator new/delete
+global do programa (simples, de vetor, nothrow, com tamanho e, a partir do C++17,
+alinhadas), inclusive nas bibliotecas do ns-3, por versões que apenas contam as
+chamadas ao new; por isso, nesse caso, deve ser incluído em uma única unidade de
+tradução de cada programa. Sem a definição, o alocador não é alterado e as alocações
+não são relatadas; o benchmark.py exige a definição e falha sem ela.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "ns3/scheduler.h"
+#include "ns3/object-factory.h"
+#include "ns3/global-value.h"
+#include "ns3/type-id.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <fcntl.h>
+#include <sstream>
+#include <string>
+#include <new>
+#include <sys/resource.h>
+#include <typeindex>
+#include <typeinfo>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+// Alocações feitas pelo operator new desde o início do processo (todas as threads);
+// permanece zero sem PROFILER_COUNT_ALLOCATIONS
+inline std::atomic<uint64_t> &
+GetProfilerAllocations (void)
+{
+  static std::atomic<uint64_t> allocations (0);
+  return allocations;
+}
+
+// Verdadeiro quando o programa foi compilado com a contagem de alocações
+inline bool
+IsCountingAllocations (void)
+{
+#ifdef PROFILER_COUNT_ALLOCATIONS
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef PROFILER_COUNT_ALLOCATIONS
+
+inline void *
+ProfilerAllocate (std::size_t size)
+{
+  GetProfilerAllocations ().fetch_add (1, std::memory_order_relaxed);
+  return std::malloc (size > 0 ? size : 1);
+}
+
+void *
+operator new (std::size_t size)
+{
+  void *p = ProfilerAllocate (size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void *
+operator new[] (std::size_t size)
+{
+  return operator new (size);
+}
+
+void *
+operator new (std::size_t size, const std::nothrow_t &) noexcept
+{
+  return ProfilerAllocate (size);
+}
+
+void *
+operator new[] (std::size_t size, const std::nothrow_t &) noexcept
+{
+  return ProfilerAllocate (size);
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete (void *p, const std::nothrow_t &) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p, const std::nothrow_t &) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete (void *p, std::size_t) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p, std::size_t) noexcept
+{
+  std::free (p);
+}
+
+#ifdef __cpp_aligned_new
+inline void *
+ProfilerAllocateAligned (std::size_t size, std::align_val_t alignment)
+{
+  GetProfilerAllocations ().fetch_add (1, std::memory_order_relaxed);
+  std::size_t align = std::max (static_cast<std::size_t> (alignment), sizeof (void *));
+  void *p = 0;
+  return posix_memalign (&p, align, size > 0 ? size : 1) == 0 ? p : 0;
+}
+
+void *
+operator new (std::size_t size, std::align_val_t alignment)
+{
+  void *p = ProfilerAllocateAligned (size, alignment);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void *
+operator new[] (std::size_t size, std::align_val_t alignment)
+{
+  return operator new (size, alignment);
+}
+
+void *
+operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  return ProfilerAllocateAligned (size, alignment);
+}
+
+void *
+operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  return ProfilerAllocateAligned (size, alignment);
+}
+
+void
+operator delete (void *p, std::align_val_t) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p, std::align_val_t) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete (void *p, std::size_t, std::align_val_t) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p, std::size_t, std::align_val_t) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete (void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p, std::align_val_t, const std::nothrow_t &) noexcept
+{
+  std::free (p);
+}
+#endif /* __cpp_aligned_new */
+
+#endif /* PROFILER_COUNT_ALLOCATIONS */
+
+namespace ns3 {
+
+class ProfilingScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  ProfilingScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+  // Contadores acumulados por todas as instâncias do simulador deste processo
+  static uint64_t GetTotalEvents (void);
+  static const std::unordered_map<std::type_index, uint64_t> &GetEventsByType (void);
+  static TypeId &GetInnerType (void);
+  static void SetCounting (bool counting);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  static uint64_t &GetTotal (void);
+  static std::unordered_map<std::type_index, uint64_t> &GetByType (void);
+  static bool &GetCounting (void);
+
+  Ptr<Scheduler> m_scheduler;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingScheduler);
+
+inline TypeId
+ProfilingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProfilingScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<ProfilingScheduler> ()
+  ;
+  return tid;
+}
+
+inline
+ProfilingScheduler::ProfilingScheduler ()
+{
+  ObjectFactory factory;
+  factory.SetTypeId (GetInnerType ());
+  m_scheduler = factory.Create<Scheduler> ();
+}
+
+inline void
+ProfilingScheduler::DoDispose (void)
+{
+  m_scheduler = 0;
+  Scheduler::DoDispose ();
+}
+
+inline void
+ProfilingScheduler::Insert (const Event &ev)
+{
+  m_scheduler->Insert (ev);
+}
+
+inline bool
+ProfilingScheduler::IsEmpty (void) const
+{
+  return m_scheduler->IsEmpty ();
+}
+
+inline Scheduler::Event
+ProfilingScheduler::PeekNext (void) const
+{
+  return m_scheduler->PeekNext ();
+}
+
+// O simulador também retira daqui os eventos cancelados, que descarta sem executar, e,
+// no Simulator::Destroy, os eventos pendentes, que também não são executados: apenas
+// os demais são contados
+inline Scheduler::Event
+ProfilingScheduler::RemoveNext (void)
+{
+  Event ev = m_scheduler->RemoveNext ();
+  if (GetCounting () && !ev.impl->IsCancelled ())
+    {
+      GetTotal ()++;
+      GetByType ()[std::type_index (typeid (*ev.impl))]++;
+    }
+  return ev;
+}
+
+inline void
+ProfilingScheduler::Remove (const Event &ev)
+{
+  m_scheduler->Remove (ev);
+}
+
+inline uint64_t &
+ProfilingScheduler::GetTotal (void)
+{
+  static uint64_t total = 0;
+  return total;
+}
+
+inline std::unordered_map<std::type_index, uint64_t> &
+ProfilingScheduler::GetByType (void)
+{
+  static std::unordered_map<std::type_index, uint64_t> byType;
+  return byType;
+}
+
+inline bool &
+ProfilingScheduler::GetCounting (void)
+{
+  static bool counting = true;
+  return counting;
+}
+
+// Liga ou desliga a contagem dos eventos retirados do escalonador
+inline void
+ProfilingScheduler::SetCounting (bool counting)
+{
+  GetCounting () = counting;
+}
+
+inline uint64_t
+ProfilingScheduler::GetTotalEvents (void)
+{
+  return GetTotal ();
+}
+
+inline const std::unordered_map<std::type_index, uint64_t> &
+ProfilingScheduler::GetEventsByType (void)
+{
+  return GetByType ();
+}
+
+// Escalonador que efetivamente ordena os eventos
+inline TypeId &
+ProfilingScheduler::GetInnerType (void)
+{
+  static TypeId inner = TypeId::LookupByName ("ns3::MapScheduler");
+  return inner;
+}
+
+class RunProfiler
+{
+public:
+  RunProfiler (const std::string &label);
+
+  static void Enable (void);
+
+  void StartPhase (const std::string &name);
+  void Stop (void);
+
+  void Print (std::ostream &os) const;
+  void WriteJson (std::ostream &os) const;
+  // Resumo em std::cerr (se 'summary') e uma linha JSON acrescentada a 'jsonFile'
+  void Report (bool summary, const std::string &jsonFile) const;
+
+private:
+  struct Phase
+  {
+    std::string name;
+    double seconds;
+    uint64_t events;
+    uint64_t allocations;
+  };
+
+  void EndPhase (void);
+  static bool CompareEventCounts (const std::pair<std::string, uint64_t> &a, const std::pair<std::string, uint64_t> &b);
+  static std::string GetTypeName (const std::type_index &type);
+  static std::string Escape (const std::string &text);
+  static std::string FormatAllocations (uint64_t allocations);
+  static long GetProcessPeakRss (void);
+
+  std::string m_label;
+  std::vector<Phase> m_phases;
+  bool m_running;
+  std::chrono::steady_clock::time_point m_phaseStart;
+  uint64_t m_phaseEvents; // total de eventos no início da fase
+  uint64_t m_phaseAllocations; // total de alocações no início da fase
+  std::unordered_map<std::type_index, uint64_t> m_startByType;
+  std::vector<std::pair<std::string, uint64_t> > m_eventsByType; // preenchido por Stop
+  long m_processPeakRss; // pico do processo inteiro até Stop [kB]
+};
+
+inline
+RunProfiler::RunProfiler (const std::string &label)
+  : m_label (label),
+    m_running (false),
+    m_phaseEvents (0),
+    m_phaseAllocations (0),
+    m_processPeakRss (0)
+{
+  m_startByType = ProfilingScheduler::GetEventsByType ();
+}
+
+// Instala o ProfilingScheduler sobre o escalonador configurado até aqui
+inline void
+RunProfiler::Enable (void)
+{
+  TypeIdValue current;
+  GlobalValue::GetValueByName ("SchedulerType", current);
+  if (current.Get () != ProfilingScheduler::GetTypeId ())
+    {
+      ProfilingScheduler::GetInnerType () = current.Get ();
+    }
+  GlobalValue::Bind ("SchedulerType", TypeIdValue (ProfilingScheduler::GetTypeId ()));
+}
+
+// Encerra a fase atual (se houver) e inicia a fase 'name'. Na fase "destroy" os eventos
+// pendentes descartados pelo Simulator::Destroy não são contados como executados.
+inline void
+RunProfiler::StartPhase (const std::string &name)
+{
+  EndPhase ();
+  ProfilingScheduler::SetCounting (name != "destroy");
+  Phase phase;
+  phase.name = name;
+  phase.seconds = 0;
+  phase.events = 0;
+  phase.allocations = 0;
+  m_phases.push_back (phase);
+  m_running = true;
+  m_phaseEvents = ProfilingScheduler::GetTotalEvents ();
+  m_phaseAllocations = GetProfilerAllocations ().load (std::memory_order_relaxed);
+  m_phaseStart = std::chrono::steady_clock::now ();
+}
+
+inline void
+RunProfiler::EndPhase (void)
+{
+  if (m_running)
+    {
+      Phase &phase = m_phases.back ();
+      phase.seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - m_phaseStart).count ();
+      phase.events = ProfilingScheduler::GetTotalEvents () - m_phaseEvents;
+      phase.allocations = GetProfilerAllocations ().load (std::memory_order_relaxed) - m_phaseAllocations;
+      m_running = false;
+    }
+}
+
+// Encerra a última fase e consolida os eventos por tipo e o pico de memória
+inline void
+RunProfiler::Stop (void)
+{
+  EndPhase ();
+  m_eventsByType.clear ();
+  const std::unordered_map<std::type_index, uint64_t> &byType = ProfilingScheduler::GetEventsByType ();
+  for (std::unordered_map<std::type_index, uint64_t>::const_iterator i = byType.begin (); i != byType.end (); i++)
+    {
+      std::unordered_map<std::type_index, uint64_t>::const_iterator start = m_startByType.find (i->first);
+      uint64_t count = i->second - (start == m_startByType.end () ? 0 : start->second);
+      if (count > 0)
+        {
+          m_eventsByType.push_back (std::make_pair (GetTypeName (i->first), count));
+        }
+    }
+  // Tipos mais frequentes primeiro
+  std::sort (m_eventsByType.begin (), m_eventsByType.end (), &RunProfiler::CompareEventCounts);
+  m_processPeakRss = GetProcessPeakRss ();
+}
+
+inline bool
+RunProfiler::CompareEventCounts (const std::pair<std::string, uint64_t> &a, const std::pair<std::string, uint64_t> &b)
+{
+  return a.second != b.second ? a.second > b.second : a.first < b.first;
+}
+
+inline std::string
+RunProfiler::GetTypeName (const std::type_index &type)
+{
+  int status = 0;
+  char *demangled = abi::__cxa_demangle (type.name (), 0, 0, &status);
+  std::string name = status == 0 ? demangled : type.name ();
+  std::free (demangled);
+  return name;
+}
+
+inline std::string
+RunProfiler::Escape (const std::string &text)
+{
+  std::string escaped;
+  for (std::size_t i = 0; i < text.size (); i++)
+    {
+      if (text[i] == '"' || text[i] == '\\')
+        {
+          escaped += '\\';
+        }
+      escaped += text[i];
+    }
+  return escaped;
+}
+
+// Alocações em JSON: null quando não são contadas
+inline std::string
+RunProfiler::FormatAllocations (uint64_t allocations)
+{
+  if (!IsCountingAllocations ())
+    {
+      return "null";
+    }
+  std::ostringstream oss;
+  oss << allocations;
+  return oss.str ();
+}
+
+// Pico de memória residente do processo desde o seu início, e não apenas desta execução
+inline long
+RunProfiler::GetProcessPeakRss (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+inline void
+RunProfiler::Print (std::ostream &os) const
+{
+  double total = 0;
+  double eventSeconds = 0;
+  uint64_t events = 0;
+  uint64_t allocations = 0;
+  for (std::size_t i = 0; i < m_phases.size (); i++)
+    {
+      total += m_phases[i].seconds;
+      events += m_phases[i].events;
+      allocations += m_phases[i].allocations;
+      if (m_phases[i].events > 0)
+        {
+          eventSeconds += m_phases[i].seconds;
+        }
+    }
+  os << "profile " << m_label << ": " << total << " s, " << events << " events";
+  if (eventSeconds > 0)
+    {
+      os << " (" << events / eventSeconds << " events/s)";
+    }
+  if (IsCountingAllocations ())
+    {
+      os << ", " << allocations << " allocations";
+    }
+  os << ", process peak RSS " << m_processPeakRss << " kB" << std::endl;
+  for (std::size_t i = 0; i < m_phases.size (); i++)
+    {
+      os << "  " << m_phases[i].name << ": " << m_phases[i].seconds << " s";
+      if (m_phases[i].events > 0)
+        {
+          os << ", " << m_phases[i].events << " events";
+        }
+      if (IsCountingAllocations ())
+        {
+          os << ", " << m_phases[i].allocations << " allocations";
+        }
+      os << std::endl;
+    }
+  for (std::size_t i = 0; i < m_eventsByType.size (); i++)
+    {
+      os << "  " << m_eventsByType[i].second << "\t" << m_eventsByType[i].first << std::endl;
+    }
+}
+
+inline void
+RunProfiler::WriteJson (std::ostream &os) const
+{
+  uint64_t events = 0;
+  uint64_t allocations = 0;
+  double eventSeconds = 0;
+  os << "{\"label\":\"" << Escape (m_label) << "\",\"phases\":[";
+  for (std::size_t i = 0; i < m_phases.size (); i++)
+    {
+      events += m_phases[i].events;
+      allocations += m_phases[i].allocations;
+      if (m_phases[i].events > 0)
+        {
+          eventSeconds += m_phases[i].seconds;
+        }
+      os << (i > 0 ? "," : "") << "{\"name\":\"" << Escape (m_phases[i].name) << "\",\"seconds\":"
+         << m_phases[i].seconds << ",\"events\":" << m_phases[i].events
+         << ",\"allocations\":" << FormatAllocations (m_phases[i].allocations) << "}";
+    }
+  os << "],\"events\":" << events << ",\"eventsPerSecond\":" << (eventSeconds > 0 ? events / eventSeconds : 0)
+     << ",\"allocations\":" << FormatAllocations (allocations) << ",\"processPeakRssKb\":" << m_processPeakRss << ",\"eventsByType\":{";
+  for (std::size_t i = 0; i < m_eventsByType.size (); i++)
+    {
+      os << (i > 0 ? "," : "") << "\"" << Escape (m_eventsByType[i].first) << "\":" << m_eventsByType[i].second;
+    }
+  os << "}}" << std::endl;
+}
+
+inline void
+RunProfiler::Report (bool summary, const std::string &jsonFile) const
+{
+  if (summary)
+    {
+      std::ostringstream oss;
+      Print (oss);
+      std::string text = oss.str ();
+      if (write (STDERR_FILENO, text.data (), text.size ()) < 0)
+        {
+          NS_LOG_UNCOND ("Falha ao escrever o resumo do perfil");
+        }
+    }
+  if (!jsonFile.empty ())
+    {
+      std::ostringstream oss;
+      WriteJson (oss);
+      std::string text = oss.str ();
+      int fd = open (jsonFile.c_str (), O_WRONLY | O_CREAT | O_APPEND, 0644);
+      if (fd < 0 || write (fd, text.data (), text.size ()) != static_cast<ssize_t> (text.size ()))
+        {
+          NS_FATAL_ERROR ("Falha ao escrever o perfil em " << jsonFile);
+        }
+      close (fd);
+    }
+}
+
+} // namespace ns3
+
+#endif /* PROFILER_H */
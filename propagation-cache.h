@@ -0,0 +1,468 @@
+/*
+## RESUMO ##
+
+Cache de propagação para topologias estáticas, compartilhado por trabalho.cc,
+power-adaptation-distance.cc e wifi-simple-interference.cc.
+
+O YansWifiChannel calcula a perda de propagação e o atraso para cada receptor a
+cada quadro transmitido. Com os nós parados (ConstantPositionMobilityModel), esses
+valores só mudam quando algum nó muda de posição, por isso:
+> CachedPropagationLossModel memoriza a potência recebida por (tx, rx, potência de tx);
+> CachedPropagationDelayModel memoriza o atraso por (tx, rx).
+Cada modelo de mobilidade visto pelo cache tem o trace "CourseChange" conectado; quando
+um nó muda de posição (por exemplo, em SetPosition), apenas as entradas que envolvem
+esse nó são descartadas.
+
+O cache só é válido para modelos determinísticos (LogDistance, Friis,
+ConstantSpeed, ...): modelos com desvanecimento aleatório devem ser usados sem ele.
+
+Uso: EnablePropagationCache (channel) substitui os modelos de um canal já criado
+(por exemplo, por YansWifiChannelHelper::Create) pelos mesmos modelos com cache.
+*/
+
+#ifndef PROPAGATION_CACHE_H
+#define PROPAGATION_CACHE_H
+
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/mobility-model.h"
+#include "ns3/pointer.h"
+#include "ns3/yans-wifi-channel.h"
+#include <cstring>
+#include <unordered_map>
+
+namespace ns3 {
+
+// Tabela de valores indexada por chaves que envolvem dois modelos de mobilidade. Guarda,
+// para cada modelo, as chaves em que ele aparece (cada uma com o outro modelo da chave),
+// e descarta essas chaves, da tabela e da lista do outro modelo, quando o modelo
+// notifica uma mudança de curso. Assim, a memória não cresce com a quantidade de
+// movimentos: cada chave aparece no máximo uma vez na lista de cada um dos seus modelos.
+template <typename Key, typename KeyHash, typename Value>
+class MobilityKeyedCache
+{
+public:
+  MobilityKeyedCache ()
+    : m_hits (0),
+      m_misses (0)
+  {
+  }
+
+  bool Find (const Key &key, Value &value) const;
+  void Insert (const Key &key, const Value &value, Ptr<MobilityModel> a, Ptr<MobilityModel> b);
+  void Invalidate (Ptr<const MobilityModel> model);
+  void Clear (void);
+  uint64_t GetHits (void) const;
+  uint64_t GetMisses (void) const;
+  std::size_t GetSize (void) const;
+  std::size_t GetWatchedKeys (void) const;
+
+private:
+  void Watch (Ptr<MobilityModel> model, const Key &key, const MobilityModel *peer);
+
+  struct Watched
+  {
+    Ptr<MobilityModel> model;
+    std::unordered_map<Key, const MobilityModel *, KeyHash> keys; // entradas que envolvem o modelo -> outro modelo da entrada
+  };
+
+  std::unordered_map<Key, Value, KeyHash> m_entries;
+  std::unordered_map<const MobilityModel *, Watched> m_watched;
+  mutable uint64_t m_hits;
+  mutable uint64_t m_misses;
+};
+
+template <typename Key, typename KeyHash, typename Value>
+bool
+MobilityKeyedCache<Key, KeyHash, Value>::Find (const Key &key, Value &value) const
+{
+  typename std::unordered_map<Key, Value, KeyHash>::const_iterator i = m_entries.find (key);
+  if (i == m_entries.end ())
+    {
+      m_misses++;
+      return false;
+    }
+  m_hits++;
+  value = i->second;
+  return true;
+}
+
+template <typename Key, typename KeyHash, typename Value>
+void
+MobilityKeyedCache<Key, KeyHash, Value>::Insert (const Key &key, const Value &value,
+                                                 Ptr<MobilityModel> a, Ptr<MobilityModel> b)
+{
+  m_entries[key] = value;
+  Watch (a, key, PeekPointer (b));
+  if (b != a)
+    {
+      Watch (b, key, PeekPointer (a));
+    }
+}
+
+template <typename Key, typename KeyHash, typename Value>
+void
+MobilityKeyedCache<Key, KeyHash, Value>::Watch (Ptr<MobilityModel> model, const Key &key, const MobilityModel *peer)
+{
+  typename std::unordered_map<const MobilityModel *, Watched>::iterator i = m_watched.find (PeekPointer (model));
+  if (i == m_watched.end ())
+    {
+      Watched watched;
+      watched.model = model;
+      i = m_watched.insert (std::make_pair (PeekPointer (model), watched)).first;
+      model->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MobilityKeyedCache::Invalidate, this));
+    }
+  i->second.keys[key] = peer;
+}
+
+// Descarta as entradas que envolvem o modelo que mudou de posição ou velocidade
+template <typename Key, typename KeyHash, typename Value>
+void
+MobilityKeyedCache<Key, KeyHash, Value>::Invalidate (Ptr<const MobilityModel> model)
+{
+  typename std::unordered_map<const MobilityModel *, Watched>::iterator i = m_watched.find (PeekPointer (model));
+  if (i == m_watched.end ())
+    {
+      return;
+    }
+  typedef typename std::unordered_map<Key, const MobilityModel *, KeyHash>::const_iterator KeyIterator;
+  for (KeyIterator k = i->second.keys.begin (); k != i->second.keys.end (); k++)
+    {
+      m_entries.erase (k->first);
+      if (k->second != PeekPointer (model))
+        {
+          // A entrada também deixa de existir para o outro modelo
+          typename std::unordered_map<const MobilityModel *, Watched>::iterator peer = m_watched.find (k->second);
+          if (peer != m_watched.end ())
+            {
+              peer->second.keys.erase (k->first);
+            }
+        }
+    }
+  i->second.keys.clear ();
+}
+
+// Esvazia o cache e desconecta os traces dos modelos de mobilidade
+template <typename Key, typename KeyHash, typename Value>
+void
+MobilityKeyedCache<Key, KeyHash, Value>::Clear (void)
+{
+  for (typename std::unordered_map<const MobilityModel *, Watched>::iterator i = m_watched.begin (); i != m_watched.end (); i++)
+    {
+      i->second.model->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&MobilityKeyedCache::Invalidate, this));
+    }
+  m_watched.clear ();
+  m_entries.clear ();
+}
+
+template <typename Key, typename KeyHash, typename Value>
+uint64_t
+MobilityKeyedCache<Key, KeyHash, Value>::GetHits (void) const
+{
+  return m_hits;
+}
+
+template <typename Key, typename KeyHash, typename Value>
+uint64_t
+MobilityKeyedCache<Key, KeyHash, Value>::GetMisses (void) const
+{
+  return m_misses;
+}
+
+// Quantidade de valores guardados
+template <typename Key, typename KeyHash, typename Value>
+std::size_t
+MobilityKeyedCache<Key, KeyHash, Value>::GetSize (void) const
+{
+  return m_entries.size ();
+}
+
+// Quantidade de chaves nas listas dos modelos: no máximo duas por valor guardado
+template <typename Key, typename KeyHash, typename Value>
+std::size_t
+MobilityKeyedCache<Key, KeyHash, Value>::GetWatchedKeys (void) const
+{
+  std::size_t keys = 0;
+  for (typename std::unordered_map<const MobilityModel *, Watched>::const_iterator i = m_watched.begin (); i != m_watched.end (); i++)
+    {
+      keys += i->second.keys.size ();
+    }
+  return keys;
+}
+
+// Par ordenado de modelos de mobilidade (transmissor, receptor) e, para a perda, a
+// potência de transmissão
+struct PropagationCacheKey
+{
+  const MobilityModel *a;
+  const MobilityModel *b;
+  double txPowerDbm;
+
+  bool operator== (const PropagationCacheKey &other) const
+  {
+    return a == other.a && b == other.b && txPowerDbm == other.txPowerDbm;
+  }
+};
+
+struct PropagationCacheKeyHash
+{
+  std::size_t operator() (const PropagationCacheKey &key) const
+  {
+    uint64_t bits;
+    std::memcpy (&bits, &key.txPowerDbm, sizeof (bits));
+    std::size_t h = std::hash<const void *> () (key.a);
+    h ^= std::hash<const void *> () (key.b) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= std::hash<uint64_t> () (bits) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+  }
+};
+
+// Perda de propagação com cache: delega ao modelo 'Model' (incluindo a cadeia de
+// modelos ligada a ele por SetNext) apenas na primeira consulta de cada par
+class CachedPropagationLossModel : public PropagationLossModel
+{
+public:
+  static TypeId GetTypeId (void);
+  CachedPropagationLossModel ();
+
+  void SetModel (Ptr<PropagationLossModel> model);
+  Ptr<PropagationLossModel> GetModel (void) const;
+  uint64_t GetHits (void) const;
+  uint64_t GetMisses (void) const;
+  std::size_t GetSize (void) const;
+  std::size_t GetWatchedKeys (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual double DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  Ptr<PropagationLossModel> m_model;
+  mutable MobilityKeyedCache<PropagationCacheKey, PropagationCacheKeyHash, double> m_cache;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationLossModel);
+
+inline TypeId
+CachedPropagationLossModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationLossModel")
+    .SetParent<PropagationLossModel> ()
+    .AddConstructor<CachedPropagationLossModel> ()
+    .AddAttribute ("Model",
+                   "The deterministic propagation loss model whose results are cached.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationLossModel::m_model),
+                   MakePointerChecker<PropagationLossModel> ())
+  ;
+  return tid;
+}
+
+inline
+CachedPropagationLossModel::CachedPropagationLossModel ()
+{
+}
+
+inline void
+CachedPropagationLossModel::SetModel (Ptr<PropagationLossModel> model)
+{
+  m_model = model;
+  m_cache.Clear ();
+}
+
+inline Ptr<PropagationLossModel>
+CachedPropagationLossModel::GetModel (void) const
+{
+  return m_model;
+}
+
+inline uint64_t
+CachedPropagationLossModel::GetHits (void) const
+{
+  return m_cache.GetHits ();
+}
+
+inline uint64_t
+CachedPropagationLossModel::GetMisses (void) const
+{
+  return m_cache.GetMisses ();
+}
+
+inline std::size_t
+CachedPropagationLossModel::GetSize (void) const
+{
+  return m_cache.GetSize ();
+}
+
+inline std::size_t
+CachedPropagationLossModel::GetWatchedKeys (void) const
+{
+  return m_cache.GetWatchedKeys ();
+}
+
+inline void
+CachedPropagationLossModel::DoDispose (void)
+{
+  m_cache.Clear ();
+  m_model = 0;
+  PropagationLossModel::DoDispose ();
+}
+
+inline double
+CachedPropagationLossModel::DoCalcRxPower (double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  PropagationCacheKey key;
+  key.a = PeekPointer (a);
+  key.b = PeekPointer (b);
+  key.txPowerDbm = txPowerDbm;
+  double rxPowerDbm;
+  if (!m_cache.Find (key, rxPowerDbm))
+    {
+      rxPowerDbm = m_model->CalcRxPower (txPowerDbm, a, b);
+      m_cache.Insert (key, rxPowerDbm, a, b);
+    }
+  return rxPowerDbm;
+}
+
+inline int64_t
+CachedPropagationLossModel::DoAssignStreams (int64_t stream)
+{
+  return m_model->AssignStreams (stream);
+}
+
+// Atraso de propagação com cache, por par (transmissor, receptor)
+class CachedPropagationDelayModel : public PropagationDelayModel
+{
+public:
+  static TypeId GetTypeId (void);
+  CachedPropagationDelayModel ();
+
+  void SetModel (Ptr<PropagationDelayModel> model);
+  std::size_t GetSize (void) const;
+  std::size_t GetWatchedKeys (void) const;
+  virtual Time GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual int64_t DoAssignStreams (int64_t stream);
+
+  Ptr<PropagationDelayModel> m_model;
+  mutable MobilityKeyedCache<PropagationCacheKey, PropagationCacheKeyHash, Time> m_cache;
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CachedPropagationDelayModel);
+
+inline TypeId
+CachedPropagationDelayModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CachedPropagationDelayModel")
+    .SetParent<PropagationDelayModel> ()
+    .AddConstructor<CachedPropagationDelayModel> ()
+    .AddAttribute ("Model",
+                   "The deterministic propagation delay model whose results are cached.",
+                   PointerValue (),
+                   MakePointerAccessor (&CachedPropagationDelayModel::m_model),
+                   MakePointerChecker<PropagationDelayModel> ())
+  ;
+  return tid;
+}
+
+inline
+CachedPropagationDelayModel::CachedPropagationDelayModel ()
+{
+}
+
+inline void
+CachedPropagationDelayModel::SetModel (Ptr<PropagationDelayModel> model)
+{
+  m_model = model;
+  m_cache.Clear ();
+}
+
+inline std::size_t
+CachedPropagationDelayModel::GetSize (void) const
+{
+  return m_cache.GetSize ();
+}
+
+inline std::size_t
+CachedPropagationDelayModel::GetWatchedKeys (void) const
+{
+  return m_cache.GetWatchedKeys ();
+}
+
+inline void
+CachedPropagationDelayModel::DoDispose (void)
+{
+  m_cache.Clear ();
+  m_model = 0;
+  PropagationDelayModel::DoDispose ();
+}
+
+inline Time
+CachedPropagationDelayModel::GetDelay (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+  PropagationCacheKey key;
+  key.a = PeekPointer (a);
+  key.b = PeekPointer (b);
+  key.txPowerDbm = 0;
+  Time delay;
+  if (!m_cache.Find (key, delay))
+    {
+      delay = m_model->GetDelay (a, b);
+      m_cache.Insert (key, delay, a, b);
+    }
+  return delay;
+}
+
+inline int64_t
+CachedPropagationDelayModel::DoAssignStreams (int64_t stream)
+{
+  return m_model->AssignStreams (stream);
+}
+
+// Troca os modelos de perda e de atraso do canal pelos mesmos modelos com cache
+inline void
+EnablePropagationCache (Ptr<YansWifiChannel> channel)
+{
+  PointerValue loss;
+  PointerValue delay;
+  channel->GetAttribute ("PropagationLossModel", loss);
+  channel->GetAttribute ("PropagationDelayModel", delay);
+
+  Ptr<CachedPropagationLossModel> cachedLoss = CreateObject<CachedPropagationLossModel> ();
+  cachedLoss->SetModel (loss.Get<PropagationLossModel> ());
+  channel->SetPropagationLossModel (cachedLoss);
+
+  Ptr<CachedPropagationDelayModel> cachedDelay = CreateObject<CachedPropagationDelayModel> ();
+  cachedDelay->SetModel (delay.Get<PropagationDelayModel> ());
+  channel->SetPropagationDelayModel (cachedDelay);
+}
+
+// Soma os valores guardados e as chaves observadas pelos caches de perda e de atraso do
+// canal; falso se o canal não usa o cache
+inline bool
+GetPropagationCacheSize (Ptr<YansWifiChannel> channel, std::size_t &entries, std::size_t &watchedKeys)
+{
+  PointerValue loss;
+  PointerValue delay;
+  channel->GetAttribute ("PropagationLossModel", loss);
+  channel->GetAttribute ("PropagationDelayModel", delay);
+  Ptr<CachedPropagationLossModel> cachedLoss = DynamicCast<CachedPropagationLossModel> (loss.Get<PropagationLossModel> ());
+  Ptr<CachedPropagationDelayModel> cachedDelay = DynamicCast<CachedPropagationDelayModel> (delay.Get<PropagationDelayModel> ());
+  if (cachedLoss == 0 || cachedDelay == 0)
+    {
+      return false;
+    }
+  entries = cachedLoss->GetSize () + cachedDelay->GetSize ();
+  watchedKeys = cachedLoss->GetWatchedKeys () + cachedDelay->GetWatchedKeys ();
+  return true;
+}
+
+} // namespace ns3
+
+#endif /* PROPAGATION_CACHE_H */
@@ -0,0 +1,194 @@
+/*
+## RESUMO ##
+
+Estatísticas de convergência compartilhadas por trabalho.cc e power-adaptation-distance.cc.
+
+> RunningStatistics: média, variância e intervalo de confiança de 95% acumulados em uma
+única passada (algoritmo de Welford), sem guardar as amostras.
+> IsSteadyState: teste de estado estacionário e de precisão sobre uma série de janelas
+de mesma duração (por exemplo, bytes recebidos a cada 'batchTime'), usado para encerrar
+uma medição de vazão assim que o erro relativo atinge o alvo:
+  1. o transiente inicial é descartado pela regra MSER: o truncamento d <= n/2 que
+  minimiza a variância da média das janelas restantes. Se o melhor truncamento for a
+  própria metade da série, o transiente ainda não terminou;
+  2. as janelas restantes são agrupadas em lotes (batch means), e o tamanho do lote
+  dobra enquanto a autocorrelação de ordem 1 entre lotes passar de 0.2 e houver ao menos
+  2 * minBatches lotes;
+  3. a medição convergiu quando há ao menos 'minBatches' lotes e a semi-amplitude do
+  intervalo de 95% da média dos lotes é no máximo 'ciTarget' vezes essa média.
+*/
+
+#ifndef RUNNING_STATISTICS_H
+#define RUNNING_STATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Acumulador de média e variância em uma única passada (algoritmo de Welford), usado
+// para combinar amostras sem guardá-las
+class RunningStatistics
+{
+public:
+  RunningStatistics ();
+
+  void Add (double x);
+  uint32_t GetCount (void) const;
+  double GetMean (void) const;
+  double GetVariance (void) const;
+  double GetHalfWidth (void) const;
+
+private:
+  uint32_t m_count;
+  double m_mean;
+  double m_m2; // soma dos quadrados dos desvios em relação à média
+};
+
+inline
+RunningStatistics::RunningStatistics ()
+  : m_count (0),
+    m_mean (0),
+    m_m2 (0)
+{
+}
+
+inline void
+RunningStatistics::Add (double x)
+{
+  m_count++;
+  double delta = x - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (x - m_mean);
+}
+
+inline uint32_t
+RunningStatistics::GetCount (void) const
+{
+  return m_count;
+}
+
+inline double
+RunningStatistics::GetMean (void) const
+{
+  return m_mean;
+}
+
+// Variância amostral
+inline double
+RunningStatistics::GetVariance (void) const
+{
+  return m_count > 1 ? m_m2 / (m_count - 1) : 0;
+}
+
+// Semi-amplitude do intervalo de confiança de 95% para a média (distribuição t de Student)
+inline double
+RunningStatistics::GetHalfWidth (void) const
+{
+  static const double t95[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+  if (m_count < 2)
+    {
+      return std::numeric_limits<double>::infinity ();
+    }
+  uint32_t df = m_count - 1;
+  double t = df <= 30 ? t95[df - 1] : (df <= 60 ? 2.000 : (df <= 120 ? 1.980 : 1.960));
+  return t * std::sqrt (GetVariance () / m_count);
+}
+
+// Autocorrelação de ordem 1 de uma série
+inline double
+GetLag1Autocorrelation (const std::vector<double> &x)
+{
+  if (x.size () < 2)
+    {
+      return 0;
+    }
+  double mean = 0;
+  for (std::size_t i = 0; i < x.size (); i++)
+    {
+      mean += x[i];
+    }
+  mean /= x.size ();
+  double numerator = 0;
+  double denominator = 0;
+  for (std::size_t i = 0; i < x.size (); i++)
+    {
+      denominator += (x[i] - mean) * (x[i] - mean);
+      if (i + 1 < x.size ())
+        {
+          numerator += (x[i] - mean) * (x[i + 1] - mean);
+        }
+    }
+  return denominator > 0 ? numerator / denominator : 0;
+}
+
+// Verifica se a série de janelas 'windows' atingiu o estado estacionário com a precisão
+// 'ciTarget' (ver o resumo acima). Em caso afirmativo, 'mean' recebe a média por janela
+// após o descarte do transiente.
+inline bool
+IsSteadyState (const std::vector<double> &windows, double ciTarget, uint32_t minBatches, double &mean)
+{
+  std::size_t n = windows.size ();
+  if (n < 2 * static_cast<std::size_t> (minBatches))
+    {
+      return false;
+    }
+
+  // MSER: somas dos sufixos para avaliar cada truncamento em O(1)
+  std::vector<double> sum (n + 1, 0);
+  std::vector<double> sumSquares (n + 1, 0);
+  for (std::size_t i = n; i > 0; i--)
+    {
+      sum[i - 1] = sum[i] + windows[i - 1];
+      sumSquares[i - 1] = sumSquares[i] + windows[i - 1] * windows[i - 1];
+    }
+  std::size_t truncation = 0;
+  double best = std::numeric_limits<double>::infinity ();
+  for (std::size_t d = 0; d <= n / 2; d++)
+    {
+      double remaining = n - d;
+      double squares = std::max (0.0, sumSquares[d] - sum[d] * sum[d] / remaining);
+      double statistic = squares / (remaining * remaining);
+      if (statistic < best)
+        {
+          best = statistic;
+          truncation = d;
+        }
+    }
+  if (truncation == n / 2)
+    {
+      return false;
+    }
+
+  // Médias por lote, dobrando o lote enquanto houver correlação entre lotes vizinhos
+  std::vector<double> batches (windows.begin () + truncation, windows.end ());
+  while (batches.size () >= 2 * static_cast<std::size_t> (minBatches) && GetLag1Autocorrelation (batches) > 0.2)
+    {
+      std::vector<double> merged;
+      for (std::size_t i = 0; i + 1 < batches.size (); i += 2)
+        {
+          merged.push_back ((batches[i] + batches[i + 1]) / 2);
+        }
+      batches.swap (merged);
+    }
+  if (batches.size () < minBatches)
+    {
+      return false;
+    }
+  RunningStatistics statistics;
+  for (std::size_t i = 0; i < batches.size (); i++)
+    {
+      statistics.Add (batches[i]);
+    }
+  if (statistics.GetHalfWidth () > ciTarget * std::fabs (statistics.GetMean ()))
+    {
+      return false;
+    }
+  mean = sum[truncation] / (n - truncation);
+  return true;
+}
+
+#endif /* RUNNING_STATISTICS_H */
@@ -39,6 +39,21 @@
 #17 - yans-wifi-channel: utilizada para trabalhar o canal que conecta os objetos da Yans-Wifi
 #18 - flow-monitor: classe para monitorar e reportar fluxo de pacotes durante uma simulação
 #19 - flow-monitor-helper: habilita o monitoramento de flow-monitor
+#20 - rng-seed-manager: define o número de execução (run) do gerador de números aleatórios
+#21 - wifi-net-device: acesso à PHY, MAC e gerenciador de estações de cada dispositivo
+#22 - regular-wifi-mac: capacidades HT/VHT/HE anunciadas pela MAC
+#23 - wifi-remote-station-manager: estado mantido sobre as estações remotas
+#24 - wifi-phy, wifi-mode, wifi-tx-vector: cálculo da duração de transmissão usado na estimativa analítica
+#25 - application, socket, seq-ts-header: base da fonte de saturação UDP
+#26 - pointer, qos-txop, wifi-mac-queue: acesso à fila AC_BE monitorada pela fonte de saturação
+#27 - ipv4-flow-classifier: identifica a quíntupla (endereços, portas e protocolo) de cada fluxo
+#28 - propagation-cache: cache da perda e do atraso de propagação entre nós estáticos
+#29 - indexed-yans-channel: canal que só agenda recepções acima de um piso de potência
+#30 - profiler: tempo de parede por fase, eventos executados e pico de memória de cada ponto
+#31 - running-statistics: teste de estado estacionário usado para encerrar cada ponto
+#32 - latency-sketch: quantis de atraso e jitter por fluxo medidos nos servidores
+#33 - config-scope: valores padrão de atributos válidos apenas durante a simulação de um lote
+#34 - tx-duration-cache: tempos de transmissão da estimativa analítica, calculados uma vez por processo
 */
 
 #include "ns3/command-line.h"
@@ -61,6 +76,43 @@
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/flow-monitor.h"
 #include "ns3/flow-monitor-helper.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/regular-wifi-mac.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-tx-vector.h"
+#include "ns3/application.h"
+#include "ns3/socket.h"
+#include "ns3/pointer.h"
+#include "ns3/qos-txop.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "propagation-cache.h"
+#include "indexed-yans-channel.h"
+#include "profiler.h"
+#include "running-statistics.h"
+#include "latency-sketch.h"
+#include "config-scope.h"
+#include "tx-duration-cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // This is a simple example in order to show how to configure an IEEE 802.11ax Wi-Fi network.
 //
@@ -69,7 +121,8 @@
 // The PHY bitrate is constant over all the simulation run. The user can also specify the distance between
 // the access point and the station: the larger the distance the smaller the goodput.
 //
-// The simulation assumes a single station in an infrastructure network:
+// By default the simulation has a single station in an infrastructure network
+// (--nStations=N places N stations on a circle around the AP):
 //
 //  STA     AP
 //    *     *
@@ -78,11 +131,2315 @@
 //
 //Packets in this simulation aren't marked with a QosTag so they are considered
 //belonging to BestEffort Access Class (AC_BE).
+//
+// Each batch of (MCS, channel width, guard interval) points restores the attribute
+// defaults it changes once it is destroyed (config-scope.h), so batches can run back to
+// back in one process or in worker processes (--workers). Without --reuseTopology every
+// point is its own batch; with it, the points of a block share one topology and start
+// while the previous point's traffic is still draining, so they are not independent.
+// The remaining options are described by --help.
+
+using namespace ns3;
+
+// Definição do componente de log: he-wifi-network
+NS_LOG_COMPONENT_DEFINE ("he-wifi-network");
+
+// Fonte UDP de saturação. Em vez de gerar um pacote a cada 10 us (um evento, uma
+// alocação e um envio por pacote, quase todos descartados na fila da MAC), mantém
+// abastecida a fila AC_BE do dispositivo Wi-Fi do nó: sempre que um quadro sai da fila
+// e a ocupação fica abaixo de 'LowWatermark', a aplicação completa a fila até
+// 'HighWatermark' em um único evento. Todos os pacotes compartilham o mesmo buffer de
+// payload (cópia sob demanda) e levam um SeqTsHeader, como os do UdpClient. Com destinos
+// adicionais (AddRemote), os pacotes são distribuídos entre eles em rodízio, de modo que
+// uma única fonte divide a fila do AP igualmente entre as estações. O rodízio só inclui
+// os destinos com o endereço MAC já resolvido no cache ARP do nó.
+class SaturationSource : public Application
+{
+public:
+  static TypeId GetTypeId (void);
+  SaturationSource ();
+  virtual ~SaturationSource ();
+
+  uint64_t GetSent (void) const;
+  void AddRemote (Address remote);
+  void Halt (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  // Situação da resolução ARP de um destino
+  enum ArpState
+  {
+    ARP_UNKNOWN, // sem entrada válida: o próximo pacote dispara uma requisição
+    ARP_PENDING, // requisição enviada; os pacotes aguardam na fila pendente do ARP
+    ARP_RESOLVED // os pacotes seguem direto para a fila da MAC
+  };
+
+  ArpState GetArpState (uint32_t index) const;
+  void Send (uint32_t index);
+  void QueueDequeued (Ptr<const WifiMacQueueItem> item);
+  void Refill (void);
+  void Watchdog (void);
+
+  Address m_peer; // destino dos pacotes
+  std::vector<Address> m_extraPeers; // destinos adicionais, atendidos em rodízio com 'm_peer'
+  uint32_t m_size; // tamanho do pacote, incluindo o SeqTsHeader [bytes]
+  uint32_t m_lowWatermark; // ocupação da fila que dispara o reabastecimento [pacotes]
+  uint32_t m_highWatermark; // ocupação desejada após o reabastecimento [pacotes]
+  uint32_t m_startupPackets; // pacotes enviados a um destino que ainda não tem o ARP resolvido
+  Time m_watchdogInterval; // verificação periódica caso nenhum quadro saia da fila
+  std::vector<Ptr<Socket> > m_sockets; // um por destino
+  std::vector<Ipv4Address> m_peerAddresses; // endereço IPv4 de cada destino (Any se não for IPv4)
+  std::vector<bool> m_resolved; // destinos incluídos no rodízio do reabastecimento atual
+  uint32_t m_nextSocket; // próximo destino do rodízio
+  Ptr<WifiMacQueue> m_queue;
+  Ptr<ArpCache> m_arpCache; // cache ARP da interface do dispositivo Wi-Fi monitorado
+  Ptr<Packet> m_payload;
+  uint32_t m_seq;
+  uint64_t m_sent;
+  EventId m_refillEvent;
+  EventId m_watchdogEvent;
+  bool m_running; // entre StartApplication e StopApplication
+};
+
+NS_OBJECT_ENSURE_REGISTERED (SaturationSource);
+
+TypeId
+SaturationSource::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SaturationSource")
+    .SetParent<Application> ()
+    .AddConstructor<SaturationSource> ()
+    .AddAttribute ("Remote", "The address of the destination",
+                   AddressValue (),
+                   MakeAddressAccessor (&SaturationSource::m_peer),
+                   MakeAddressChecker ())
+    .AddAttribute ("PacketSize", "Size of the packets sent, including the 12-byte SeqTsHeader",
+                   UintegerValue (1472),
+                   MakeUintegerAccessor (&SaturationSource::m_size),
+                   MakeUintegerChecker<uint32_t> (12, 65507))
+    .AddAttribute ("LowWatermark", "MAC queue occupancy (packets) below which the queue is refilled",
+                   UintegerValue (128),
+                   MakeUintegerAccessor (&SaturationSource::m_lowWatermark),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HighWatermark", "MAC queue occupancy (packets) reached after each refill",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&SaturationSource::m_highWatermark),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("StartupPackets", "Packets sent to a destination whose ARP entry is missing or expired; nothing more "
+                   "is sent to it until the entry resolves (the default matches ArpCache::PendingQueueSize)",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&SaturationSource::m_startupPackets),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("WatchdogInterval", "Period of the fallback check used when no frame leaves the queue",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&SaturationSource::m_watchdogInterval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+SaturationSource::SaturationSource ()
+  : m_nextSocket (0),
+    m_seq (0),
+    m_sent (0),
+    m_running (false)
+{
+}
+
+SaturationSource::~SaturationSource ()
+{
+}
+
+uint64_t
+SaturationSource::GetSent (void) const
+{
+  return m_sent;
+}
+
+// Acrescenta um destino, antes do início da aplicação
+void
+SaturationSource::AddRemote (Address remote)
+{
+  m_extraPeers.push_back (remote);
+}
+
+// Interrompe o envio antes do instante de parada (ponto encerrado por convergência); a
+// parada agendada que ainda ocorrer depois não tem efeito
+void
+SaturationSource::Halt (void)
+{
+  StopApplication ();
+}
+
+void
+SaturationSource::DoDispose (void)
+{
+  m_sockets.clear ();
+  m_queue = 0;
+  m_arpCache = 0;
+  m_payload = 0;
+  Application::DoDispose ();
+}
+
+void
+SaturationSource::StartApplication (void)
+{
+  // A fila monitorada é a do AC_BE do primeiro dispositivo Wi-Fi do nó
+  for (uint32_t i = 0; i < GetNode ()->GetNDevices () && m_queue == 0; i++)
+    {
+      Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (GetNode ()->GetDevice (i));
+      if (device != 0)
+        {
+          PointerValue ptr;
+          device->GetMac ()->GetAttribute ("BE_Txop", ptr);
+          m_queue = ptr.Get<QosTxop> ()->GetWifiMacQueue ();
+          Ptr<Ipv4L3Protocol> ipv4 = GetNode ()->GetObject<Ipv4L3Protocol> ();
+          int32_t interface = ipv4 != 0 ? ipv4->GetInterfaceForDevice (device) : -1;
+          if (interface >= 0)
+            {
+              m_arpCache = ipv4->GetInterface (interface)->GetArpCache ();
+            }
+        }
+    }
+  NS_ABORT_MSG_IF (m_queue == 0, "SaturationSource requires a Wi-Fi device on node " << GetNode ()->GetId ());
+  m_queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&SaturationSource::QueueDequeued, this));
+
+  std::vector<Address> peers (1, m_peer);
+  peers.insert (peers.end (), m_extraPeers.begin (), m_extraPeers.end ());
+  for (uint32_t i = 0; i < peers.size (); i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (GetNode (), TypeId::LookupByName ("ns3::UdpSocketFactory"));
+      socket->Bind ();
+      socket->Connect (peers[i]);
+      m_sockets.push_back (socket);
+      m_peerAddresses.push_back (InetSocketAddress::IsMatchingType (peers[i])
+                                 ? InetSocketAddress::ConvertFrom (peers[i]).GetIpv4 ()
+                                 : Ipv4Address::GetAny ());
+    }
+  m_resolved.assign (m_sockets.size (), false);
+  m_payload = Create<Packet> (m_size - 12);
+  m_running = true;
+  Refill ();
+}
+
+void
+SaturationSource::StopApplication (void)
+{
+  if (!m_running)
+    {
+      return;
+    }
+  m_running = false;
+  Simulator::Cancel (m_refillEvent);
+  Simulator::Cancel (m_watchdogEvent);
+  if (m_queue != 0)
+    {
+      m_queue->TraceDisconnectWithoutContext ("Dequeue", MakeCallback (&SaturationSource::QueueDequeued, this));
+    }
+  for (uint32_t i = 0; i < m_sockets.size (); i++)
+    {
+      m_sockets[i]->Close ();
+    }
+}
+
+// Chamado pela fila da MAC a cada quadro retirado. O reabastecimento é agendado para
+// o mesmo instante, fora da pilha de chamadas da MAC.
+void
+SaturationSource::QueueDequeued (Ptr<const WifiMacQueueItem> item)
+{
+  if (!m_refillEvent.IsRunning () && m_queue->GetNPackets () < m_lowWatermark)
+    {
+      m_refillEvent = Simulator::ScheduleNow (&SaturationSource::Refill, this);
+    }
+}
+
+// Consulta o cache ARP sem alterá-lo. Uma entrada viva mas expirada conta como ausente,
+// pois o próximo pacote renova a requisição e fica retido na fila pendente; o mesmo vale
+// para uma entrada morta. Destinos fora do IPv4 não passam pelo ARP.
+SaturationSource::ArpState
+SaturationSource::GetArpState (uint32_t index) const
+{
+  if (m_arpCache == 0 || m_peerAddresses[index] == Ipv4Address::GetAny ())
+    {
+      return ARP_RESOLVED;
+    }
+  ArpCache::Entry *entry = m_arpCache->Lookup (m_peerAddresses[index]);
+  if (entry == 0 || entry->IsDead ())
+    {
+      return ARP_UNKNOWN;
+    }
+  if (entry->IsPermanent ())
+    {
+      return ARP_RESOLVED;
+    }
+  if (entry->IsWaitReply ())
+    {
+      return ARP_PENDING;
+    }
+  return entry->IsExpired () ? ARP_UNKNOWN : ARP_RESOLVED;
+}
+
+// Envia um pacote ao destino 'index'
+void
+SaturationSource::Send (uint32_t index)
+{
+  Ptr<Packet> packet = m_payload->Copy ();
+  SeqTsHeader seqTs;
+  seqTs.SetSeq (m_seq++);
+  packet->AddHeader (seqTs);
+  m_sockets[index]->Send (packet);
+  m_sent++;
+}
+
+// Completa a fila até 'HighWatermark'. Enquanto o ARP de um destino não está resolvido,
+// seus pacotes ficam retidos na fila pendente do ARP, que guarda poucos por destino e
+// descarta os demais: um destino sem entrada recebe 'StartupPackets' pacotes, que disparam
+// a requisição, e nada mais até a resposta chegar. A fila da MAC é completada em rodízio
+// apenas entre os destinos resolvidos.
+void
+SaturationSource::Refill (void)
+{
+  uint32_t resolved = 0;
+  for (uint32_t i = 0; i < m_sockets.size (); i++)
+    {
+      ArpState state = GetArpState (i);
+      m_resolved[i] = state == ARP_RESOLVED;
+      resolved += m_resolved[i] ? 1 : 0;
+      for (uint32_t j = 0; state == ARP_UNKNOWN && j < m_startupPackets; j++)
+        {
+          Send (i);
+        }
+    }
+  for (uint32_t i = m_queue->GetNPackets (); i < m_highWatermark && resolved > 0; i++)
+    {
+      while (!m_resolved[m_nextSocket])
+        {
+          m_nextSocket = (m_nextSocket + 1) % m_sockets.size ();
+        }
+      Send (m_nextSocket);
+      m_nextSocket = (m_nextSocket + 1) % m_sockets.size ();
+    }
+  Simulator::Cancel (m_watchdogEvent);
+  m_watchdogEvent = Simulator::Schedule (m_watchdogInterval, &SaturationSource::Watchdog, this);
+}
+
+// Garante o reabastecimento enquanto a fila ainda não recebe pacotes (por exemplo,
+// durante a resolução ARP, quando os pacotes ficam retidos antes da MAC)
+void
+SaturationSource::Watchdog (void)
+{
+  if (m_queue->GetNPackets () < m_lowWatermark)
+    {
+      Refill ();
+    }
+  else
+    {
+      m_watchdogEvent = Simulator::Schedule (m_watchdogInterval, &SaturationSource::Watchdog, this);
+    }
+}
+
+// Ponto da varredura: uma combinação de MCS, largura do canal e intervalo de guarda
+struct SweepPoint
+{
+  int mcs; // índice HE MCS (0 a 11)
+  int channelWidth; // largura do canal [MHz]
+  int gi; // intervalo de guarda [ns]
+  uint32_t run; // número de execução (RngRun) utilizado pelo ponto
+  bool udp; // transporte do ponto (no modo duplo, cada combinação aparece com UDP e com TCP)
+};
+
+// Parâmetros de simulação compartilhados por todos os pontos da varredura
+struct SweepConfig
+{
+  bool udp;
+  double simulationTime;
+  double distance;
+  double frequency;
+  bool useRts;
+  bool reuseTopology; // constrói a topologia uma única vez e apenas reconfigura PHY/gerenciador
+  bool saturationSource; // usa a SaturationSource no lugar do UdpClient de 10 us
+  bool flowStats; // instala o FlowMonitor e coleta os contadores por fluxo de cada ponto
+  bool cachePropagation; // memoriza perda e atraso de propagação entre os nós (estáticos)
+  bool indexedChannel; // canal com índice espacial, que descarta recepções abaixo do piso
+  double rxPowerFloor; // piso de potência recebida do canal indexado [dBm]
+  bool profile; // imprime o perfil de execução de cada ponto
+  std::string profileFile; // arquivo com o perfil de cada ponto em JSON (uma linha por ponto)
+  double convergenceTarget; // erro relativo que encerra cada ponto (0 = duração fixa)
+  double batchTime; // duração de cada janela de amostragem da vazão [s]
+  uint32_t minBatches; // quantidade mínima de lotes antes de encerrar um ponto
+  uint32_t nStations; // STAs associadas ao AP; acima de 1, modo denso com fluxos nas duas direções
+  double stationRate; // taxa oferecida por fluxo [Mbit/s] (0 = saturação)
+  bool latency; // mede o atraso e o jitter dos pacotes recebidos pelos servidores
+  bool dual; // simula cada combinação com UDP e com TCP e compara as vazões
+};
+
+// Configuração efetiva de um ponto: o transporte vem do próprio ponto, de modo que no
+// modo duplo cada processo filho simula com o transporte dos seus pontos
+static SweepConfig
+GetPointConfig (const SweepConfig &config, const SweepPoint &point)
+{
+  SweepConfig pointConfig = config;
+  pointConfig.udp = point.udp;
+  return pointConfig;
+}
+
+// Contadores de um fluxo do FlowMonitor durante um ponto da varredura. O registro tem
+// tamanho fixo e é gravado sem conversão (ordem de bytes da máquina) no arquivo de
+// estatísticas, precedido pelo cabeçalho "HESTATS1" e pelo tamanho do registro.
+struct FlowRecord
+{
+  int32_t mcs;
+  int32_t channelWidth; // [MHz]
+  int32_t gi; // [ns]
+  uint32_t flowId;
+  uint32_t sourceAddress;
+  uint32_t destinationAddress;
+  uint16_t sourcePort;
+  uint16_t destinationPort;
+  uint32_t protocol;
+  uint64_t txBytes;
+  uint64_t rxBytes;
+  uint32_t txPackets;
+  uint32_t rxPackets;
+  uint32_t lostPackets;
+  uint32_t timesForwarded;
+  int64_t delaySum; // [ns]
+  int64_t jitterSum; // [ns]
+};
+
+static const char g_statsMagic[8] = { 'H', 'E', 'S', 'T', 'A', 'T', 'S', '1' };
+
+// Métricas de um ponto no modo denso: vazões a partir dos contadores do FlowMonitor e
+// atraso a partir do LatencyMonitor de cada direção
+struct DenseMetrics
+{
+  double downlink; // vazão agregada AP -> STAs [Mbit/s]
+  double uplink; // vazão agregada STAs -> AP [Mbit/s]
+  double fairness; // índice de Jain da vazão de cada estação (descida + subida)
+  double latency[2][3]; // atraso [ms] nos percentis 50, 99 e 99.9: [0] descida, [1] subida
+};
+
+// Resultado de um ponto da varredura
+struct SweepResult
+{
+  double throughput; // vazão na camada de aplicação [Mbit/s]
+  double latency[3]; // atraso em um sentido [ms] nos percentis 50, 99 e 99.9 (todos os fluxos)
+  double jitter[3]; // jitter [ms] nos mesmos percentis
+  double estimate; // vazão prevista pelo modelo analítico [Mbit/s]
+  bool simulated; // falso quando o ponto foi decidido apenas pela estimativa
+  bool failed; // verdadeiro quando o processo que simulava o ponto falhou
+  std::vector<FlowRecord> flows; // contadores por fluxo, se as estatísticas estiverem habilitadas
+  DenseMetrics dense; // zerado fora do modo denso
+  std::vector<double> stations; // vazão de descida e de subida de cada estação [Mbit/s] (modo denso)
+};
+
+// Nós, dispositivos e aplicações de uma simulação. No modo de reuso a mesma topologia
+// atende a todos os pontos de um lote; apenas o cliente é recriado a cada ponto.
+struct SweepTopology
+{
+  NodeContainer wifiStaNode;
+  NodeContainer wifiApNode;
+  std::vector<Ptr<WifiNetDevice> > staDevices;
+  Ptr<WifiNetDevice> apDevice;
+  std::vector<Ipv4Address> staAddresses;
+  Ipv4Address apAddress;
+  ApplicationContainer servers; // um por STA e, no modo denso, o do AP (fluxos de subida)
+  uint32_t payloadSize;
+};
+
+// Processo filho responsável por um lote de pontos da varredura
+struct SweepWorker
+{
+  pid_t pid;
+  int fd; // extremidade de leitura do pipe com os resultados
+  std::vector<std::size_t> indices; // posições dos pontos do lote na tabela
+  std::string data; // bytes recebidos do filho e ainda não decodificados
+};
+
+// Tamanho do payload da aplicação: 1500 bytes de pacote IP menos os cabeçalhos UDP/IP ou TCP/IP
+static uint32_t
+GetPayloadSize (bool udp)
+{
+  return udp ? 1472 : 1448; // bytes
+}
+
+// Duração de um quadro HE SU de 'size' bytes no modo HeMcs<mcs>, na largura e no GI do ponto
+static Time
+GetHeFrameDuration (uint32_t size, uint32_t mcs, const SweepConfig &config, const SweepPoint &point)
+{
+  std::ostringstream oss;
+  oss << "HeMcs" << mcs;
+  WifiTxVector txVector;
+  txVector.SetMode (WifiMode (oss.str ()));
+  txVector.SetPreambleType (WIFI_PREAMBLE_HE_SU);
+  txVector.SetChannelWidth (point.channelWidth);
+  txVector.SetGuardInterval (point.gi);
+  txVector.SetNss (1);
+  return TxDurationCache::GetTxDuration (size, txVector, config.frequency == 5.0 ? 5180 : 2412);
+}
+
+// Menor duração possível de uma resposta de controle (CTS ou BlockAck) de 'size' bytes. O
+// gerenciador de estações escolhe o modo da resposta entre as taxas básicas da BSS e os
+// modos obrigatórios que não superam o do quadro que a solicita; como essa escolha depende
+// da BSS, vale o mais rápido entre os modos OFDM legados e os modos HE até o do ponto.
+static Time
+GetMinResponseDuration (uint32_t size, const SweepConfig &config, const SweepPoint &point)
+{
+  const char *names5[] = { "OfdmRate6Mbps", "OfdmRate9Mbps", "OfdmRate12Mbps", "OfdmRate18Mbps",
+                           "OfdmRate24Mbps", "OfdmRate36Mbps", "OfdmRate48Mbps", "OfdmRate54Mbps" };
+  const char *names24[] = { "ErpOfdmRate6Mbps", "ErpOfdmRate9Mbps", "ErpOfdmRate12Mbps", "ErpOfdmRate18Mbps",
+                            "ErpOfdmRate24Mbps", "ErpOfdmRate36Mbps", "ErpOfdmRate48Mbps", "ErpOfdmRate54Mbps" };
+  Time duration = Seconds (1);
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      WifiTxVector txVector;
+      txVector.SetMode (WifiMode (config.frequency == 5.0 ? names5[i] : names24[i]));
+      txVector.SetPreambleType (WIFI_PREAMBLE_LONG);
+      txVector.SetChannelWidth (20);
+      duration = std::min (duration, TxDurationCache::GetTxDuration (size, txVector, config.frequency == 5.0 ? 5180 : 2412));
+    }
+  for (uint32_t mcs = 0; mcs <= point.mcs; mcs++)
+    {
+      duration = std::min (duration, GetHeFrameDuration (size, mcs, config, point));
+    }
+  return duration;
+}
+
+// Tamanho máximo de uma A-MPDU de AC_BE: o atributo BE_MaxAmpduSize das MACs instaladas
+// por BuildSweepTopology, que não o alteram (o maior entre AP e STA)
+static uint32_t
+GetMaxAmpduSize (void)
+{
+  uint32_t maxAmpduSize = 0;
+  const char *macs[] = { "ns3::ApWifiMac", "ns3::StaWifiMac" };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      TypeId::AttributeInformation info;
+      if (!TypeId::LookupByName (macs[i]).LookupAttributeByName ("BE_MaxAmpduSize", &info))
+        {
+          NS_FATAL_ERROR (macs[i] << " has no BE_MaxAmpduSize attribute");
+        }
+      Ptr<const UintegerValue> value = DynamicCast<const UintegerValue> (info.initialValue);
+      maxAmpduSize = std::max<uint32_t> (maxAmpduSize, value->Get ());
+    }
+  return maxAmpduSize;
+}
+
+// Subquadros de 'mpduSize' bytes em uma A-MPDU: cada um tem um delimitador de 4 bytes e,
+// exceto o último, é alinhado em 4 bytes. O limite é o menor entre BE_MaxAmpduSize e a
+// janela de BlockAck de 64 MPDUs.
+static uint32_t
+GetMaxMpdus (uint32_t mpduSize)
+{
+  uint32_t maxAmpduSize = GetMaxAmpduSize ();
+  uint32_t subframeSize = ((mpduSize + 4 + 3) / 4) * 4;
+  if (maxAmpduSize < mpduSize + 4)
+    {
+      return 1;
+    }
+  return std::min<uint32_t> (64, (maxAmpduSize - mpduSize - 4) / subframeSize + 1);
+}
+
+// Troca de quadros de uma transmissão, sem o acesso ao meio: o RTS/CTS opcional, a A-MPDU
+// com 'nMpdus' subquadros e o BlockAck após SIFS. O RTS é enviado no ControlMode do
+// ponto (HeMcs<mcs>, como em BuildSweepTopology) e as respostas na menor duração possível.
+static Time
+GetExchangeDuration (uint32_t nMpdus, uint32_t mpduSize, const SweepConfig &config, const SweepPoint &point)
+{
+  Time sifs = MicroSeconds (config.frequency == 5.0 ? 16 : 10);
+  uint32_t subframeSize = ((mpduSize + 4 + 3) / 4) * 4;
+  Time exchange = GetHeFrameDuration ((nMpdus - 1) * subframeSize + mpduSize + 4, point.mcs, config, point)
+    + sifs + GetMinResponseDuration (32, config, point);
+  if (config.useRts)
+    {
+      exchange += GetHeFrameDuration (20, point.mcs, config, point) + sifs
+        + GetMinResponseDuration (14, config, point) + sifs;
+    }
+  return exchange;
+}
+
+// Tamanho de um MPDU de dados: payload, LLC/SNAP (8), IPv4 (20), UDP (8) ou TCP com
+// timestamps (32), MAC QoS (26) e FCS (4)
+static uint32_t
+GetDataMpduSize (bool udp)
+{
+  return GetPayloadSize (udp) + 8 + 20 + (udp ? 8 : 32) + 26 + 4;
+}
+
+// Estimativa analítica da vazão de saturação de um ponto, sem executar a simulação.
+// Cada ciclo é um acesso EDCA (AIFS do AC_BE e backoff médio de CWmin/2 slots) seguido
+// da troca de GetExchangeDuration com o maior número de MPDUs permitido. No TCP é
+// acrescentado o acesso da STA para enviar os ACKs (um a cada dois segmentos). É um
+// valor médio sem perdas nem colisões, e não um limite: a triagem usa GetThroughputBound.
+static double
+EstimateThroughput (const SweepConfig &config, const SweepPoint &point)
+{
+  uint32_t payloadSize = GetPayloadSize (config.udp);
+  uint32_t mpduSize = GetDataMpduSize (config.udp);
+  uint32_t nMpdus = GetMaxMpdus (mpduSize);
+  uint64_t sifsNs = config.frequency == 5.0 ? 16000 : 10000;
+  uint64_t slotNs = 9000;
+  Time access = NanoSeconds (sifsNs + 3 * slotNs + 15 * slotNs / 2); // AIFSN = 3 e CWmin = 15 do AC_BE
+
+  Time cycle = access + GetExchangeDuration (nMpdus, mpduSize, config, point);
+  if (!config.udp)
+    {
+      // ACKs TCP: LLC/SNAP, IPv4, TCP com timestamps, MAC QoS e FCS
+      uint32_t nAcks = std::max<uint32_t> (1, nMpdus / 2);
+      cycle += access + GetExchangeDuration (nAcks, 8 + 20 + 32 + 26 + 4, config, point);
+    }
+  return (nMpdus * payloadSize * 8) / (cycle.GetSeconds () * 1000000.0); //Mbit/s
+}
+
+// Limite superior da vazão medida em um ponto. Cada transmissão no canal leva ao menos
+// o AIFS do AC_BE (sem backoff), a troca de GetExchangeDuration e, no máximo, o número
+// de MPDUs que a MAC aceita agregar; os ACKs do TCP e as transmissões sem agregação só
+// aumentariam o tempo. Uma transmissão já iniciada pode terminar dentro da janela de
+// medição (simulationTime ou, com convergenceTarget, um único lote), o que soma no máximo
+// uma A-MPDU a essa janela.
+static double
+GetThroughputBound (const SweepConfig &config, const SweepPoint &point)
+{
+  uint32_t payloadSize = GetPayloadSize (config.udp);
+  uint32_t mpduSize = GetDataMpduSize (config.udp);
+  uint32_t nMpdus = GetMaxMpdus (mpduSize);
+  Time aifs = MicroSeconds ((config.frequency == 5.0 ? 16 : 10) + 3 * 9);
+  Time cycle = aifs + GetExchangeDuration (nMpdus, mpduSize, config, point);
+  double window = config.convergenceTarget > 0 ? config.batchTime : config.simulationTime;
+  double bits = nMpdus * payloadSize * 8.0;
+  return (bits / cycle.GetSeconds () + bits / window) / 1000000.0; //Mbit/s
+}
+
+// Constrói nós, canal, dispositivos, pilha IP e o servidor para o ponto informado. Os
+// atributos são passados diretamente aos objetos da topologia; apenas o tamanho do
+// segmento TCP, que não tem caminho por objeto, é alterado em 'scope', que deve existir
+// até o Simulator::Destroy da topologia.
+static void
+BuildSweepTopology (const SweepConfig &config, const SweepPoint &point, SweepTopology &topology, ConfigScope &scope)
+{
+  topology.payloadSize = GetPayloadSize (config.udp);
+  if (!config.udp)
+    {
+      // Os sockets TCP são criados pelas aplicações ao iniciar, com o valor padrão, e não
+      // aceitam outro tamanho de segmento depois de conectados ou em escuta
+      scope.SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (topology.payloadSize));
+    }
+
+  // Define os nós STA e AP
+  NodeContainer wifiStaNode;
+  wifiStaNode.Create (config.nStations);
+  NodeContainer wifiApNode;
+  wifiApNode.Create (1);
+
+  // Criação do canal, com os modelos de YansWifiChannelHelper::Default ()
+  YansWifiChannelHelper channel;
+  channel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  if (config.frequency == 2.4)
+    {
+      channel.AddPropagationLoss ("ns3::LogDistancePropagationLossModel", "ReferenceLoss", DoubleValue (40.046));
+    }
+  else
+    {
+      channel.AddPropagationLoss ("ns3::LogDistancePropagationLossModel");
+    }
+  // O helper indexado é copiado como YansWifiPhyHelper, mantendo o tipo de PHY que ele cria
+  YansWifiPhyHelper phy = config.indexedChannel ? IndexedYansWifiPhyHelper::Default () : YansWifiPhyHelper::Default ();
+  Ptr<YansWifiChannel> wifiChannel = config.indexedChannel ? CreateIndexedChannel (channel, config.rxPowerFloor) : channel.Create ();
+  if (config.cachePropagation)
+    {
+      // Os nós não se movem: a perda e o atraso de cada par são calculados uma única vez
+      EnablePropagationCache (wifiChannel);
+    }
+  phy.SetChannel (wifiChannel);
+
+  // Define o intervalo de guarda
+  phy.Set ("GuardInterval", TimeValue (NanoSeconds (point.gi)));
+
+  // Configuração da MAC layer
+  WifiMacHelper mac;
+  WifiHelper wifi;
+  if (config.frequency == 5.0)
+    {
+      wifi.SetStandard (WIFI_PHY_STANDARD_80211ax_5GHZ);
+    }
+  else
+    {
+      wifi.SetStandard (WIFI_PHY_STANDARD_80211ax_2_4GHZ);
+    }
+
+  // Configuração dos dispositivos
+  std::ostringstream oss;
+  oss << "HeMcs" << point.mcs;
+  if (config.useRts)
+    {
+      // Configuração do mecanismo de redução de colisão: RTS antes de todo quadro
+      wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager","DataMode", StringValue (oss.str ()),
+                                    "ControlMode", StringValue (oss.str ()),
+                                    "RtsCtsThreshold", StringValue ("0"));
+    }
+  else
+    {
+      wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager","DataMode", StringValue (oss.str ()),
+                                    "ControlMode", StringValue (oss.str ()));
+    }
+
+  Ssid ssid = Ssid ("ns3-80211ax");
+
+  mac.SetType ("ns3::StaWifiMac",
+               "Ssid", SsidValue (ssid));
+
+  NetDeviceContainer staDevice;
+  staDevice = wifi.Install (phy, mac, wifiStaNode);
+
+  mac.SetType ("ns3::ApWifiMac",
+               "EnableBeaconJitter", BooleanValue (false),
+               "Ssid", SsidValue (ssid));
+
+  NetDeviceContainer apDevice;
+  apDevice = wifi.Install (phy, mac, wifiApNode);
+
+  // Define a largura do canal apenas nos dispositivos desta topologia
+  NetDeviceContainer devices = staDevice;
+  devices.Add (apDevice);
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ()->SetAttribute ("ChannelWidth", UintegerValue (point.channelWidth));
+    }
+
+  // Configuração de mobilidade dos objetos que caracterizam os dispositivos
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+
+  // AP na origem e STAs distribuídas em um círculo de raio 'distance' ao seu redor
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  for (uint32_t i = 0; i < config.nStations; i++)
+    {
+      double angle = 2 * M_PI * i / config.nStations;
+      positionAlloc->Add (Vector (config.distance * std::cos (angle), config.distance * std::sin (angle), 0.0));
+    }
+  mobility.SetPositionAllocator (positionAlloc);
+
+  // Modelo em que a posição atual não é alterada quando já foi configurada a não ser que seja reconfigurada
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiApNode);
+  mobility.Install (wifiStaNode);
+
+
+  // Configura pilha de protocolos IP
+  // A classe InternetStackHelper agrega funcionalidades IP/TCP/UDP aos nós
+  InternetStackHelper stack;
+  stack.Install (wifiApNode);
+  stack.Install (wifiStaNode);
+  Ipv4AddressHelper address;
+  if (config.nStations > 1)
+    {
+      // Comporta centenas de STAs na mesma sub-rede
+      address.SetBase ("10.1.0.0", "255.255.0.0");
+    }
+  else
+    {
+      address.SetBase ("192.168.1.0", "255.255.255.0");
+    }
+  Ipv4InterfaceContainer staNodeInterface;
+  Ipv4InterfaceContainer apNodeInterface;
+  staNodeInterface = address.Assign (staDevice);
+  apNodeInterface = address.Assign (apDevice);
+
+  // Configuração dos servidores, um por STA e, no modo denso, um no AP para os fluxos de
+  // subida; permanecem ativos durante todo o lote
+  NodeContainer serverNodes = wifiStaNode;
+  if (config.nStations > 1)
+    {
+      serverNodes.Add (wifiApNode);
+    }
+  ApplicationContainer serverApp;
+  if (config.udp)
+    {
+      // UDP flow
+      uint16_t port = 9;
+      UdpServerHelper server (port);
+      serverApp = server.Install (serverNodes);
+    }
+  else
+    {
+      // TCP flow
+      uint16_t port = 50000;
+      Address localAddress (InetSocketAddress (Ipv4Address::GetAny (), port));
+      PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", localAddress);
+      serverApp = packetSinkHelper.Install (serverNodes);
+    }
+  serverApp.Start (Seconds (0.0));
+
+  topology.wifiStaNode = wifiStaNode;
+  topology.wifiApNode = wifiApNode;
+  for (uint32_t i = 0; i < config.nStations; i++)
+    {
+      topology.staDevices.push_back (DynamicCast<WifiNetDevice> (staDevice.Get (i)));
+      topology.staAddresses.push_back (staNodeInterface.GetAddress (i));
+    }
+  topology.apDevice = DynamicCast<WifiNetDevice> (apDevice.Get (0));
+  topology.apAddress = apNodeInterface.GetAddress (0);
+  topology.servers = serverApp;
+}
+
+// Instala os clientes do ponto atual. Os instantes de início e fim são relativos ao
+// momento da instalação, de modo que cada ponto tem 1 s de preparação seguido de
+// 'simulationTime' segundos de tráfego. Fora do modo denso há um único fluxo AP -> STA;
+// no modo denso, um fluxo de descida e um de subida por STA.
+static ApplicationContainer
+InstallSweepClient (const SweepConfig &config, const SweepTopology &topology)
+{
+  ApplicationContainer clientApp;
+  bool dense = config.nStations > 1;
+  uint16_t port = config.udp ? 9 : 50000;
+  // Pares (origem, destino) dos fluxos: primeiro os de descida, depois os de subida
+  std::vector<std::pair<Ptr<Node>, Ipv4Address> > flows;
+  for (uint32_t i = 0; i < topology.staAddresses.size (); i++)
+    {
+      flows.push_back (std::make_pair (topology.wifiApNode.Get (0), topology.staAddresses[i]));
+    }
+  if (dense)
+    {
+      for (uint32_t i = 0; i < topology.wifiStaNode.GetN (); i++)
+        {
+          flows.push_back (std::make_pair (topology.wifiStaNode.Get (i), topology.apAddress));
+        }
+    }
+
+  if (config.udp && config.saturationSource && config.stationRate == 0)
+    {
+      // Uma fonte por nó: a do AP atende às STAs em rodízio
+      Ptr<SaturationSource> apSource;
+      for (uint32_t i = 0; i < flows.size (); i++)
+        {
+          Address remote = InetSocketAddress (flows[i].second, port);
+          if (apSource != 0 && flows[i].first == topology.wifiApNode.Get (0))
+            {
+              apSource->AddRemote (remote);
+              continue;
+            }
+          Ptr<SaturationSource> source = CreateObject<SaturationSource> ();
+          source->SetAttribute ("Remote", AddressValue (remote));
+          source->SetAttribute ("PacketSize", UintegerValue (topology.payloadSize));
+          flows[i].first->AddApplication (source);
+          clientApp.Add (source);
+          if (apSource == 0)
+            {
+              apSource = source;
+            }
+        }
+    }
+  else if (config.udp)
+    {
+      // Sem taxa definida, um pacote a cada 10 us (saturação)
+      Time interval = Time ("0.00001");
+      if (config.stationRate > 0)
+        {
+          interval = Seconds (topology.payloadSize * 8 / (config.stationRate * 1000000.0));
+        }
+      for (uint32_t i = 0; i < flows.size (); i++)
+        {
+          UdpClientHelper client (flows[i].second, port);
+          client.SetAttribute ("MaxPackets", UintegerValue (4294967295u));
+          client.SetAttribute ("Interval", TimeValue (interval)); //packets/s
+          client.SetAttribute ("PacketSize", UintegerValue (topology.payloadSize));
+          clientApp.Add (client.Install (flows[i].first));
+        }
+    }
+  else
+    {
+      uint64_t rate = config.stationRate > 0 ? config.stationRate * 1000000 : 1000000000;
+      for (uint32_t i = 0; i < flows.size (); i++)
+        {
+          OnOffHelper onoff ("ns3::TcpSocketFactory", Ipv4Address::GetAny ());
+          onoff.SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
+          onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
+          onoff.SetAttribute ("PacketSize", UintegerValue (topology.payloadSize));
+          onoff.SetAttribute ("DataRate", DataRateValue (rate)); //bit/s
+          AddressValue remoteAddress (InetSocketAddress (flows[i].second, port));
+          onoff.SetAttribute ("Remote", remoteAddress);
+          clientApp.Add (onoff.Install (flows[i].first));
+        }
+    }
+  clientApp.Start (Seconds (1.0));
+  clientApp.Stop (Seconds (config.simulationTime + 1));
+  return clientApp;
+}
+
+// Silencia os clientes de um ponto encerrado antes de 'simulationTime', para que eles não
+// continuem transmitindo durante o ponto seguinte da mesma topologia. Os eventos de parada
+// já agendados continuam pendentes e não têm efeito sobre um cliente silenciado.
+static void
+HaltSweepClient (const SweepConfig &config, const ApplicationContainer &clients)
+{
+  for (uint32_t i = 0; i < clients.GetN (); i++)
+    {
+      Ptr<SaturationSource> source = DynamicCast<SaturationSource> (clients.Get (i));
+      if (source != 0)
+        {
+          source->Halt ();
+        }
+      else if (config.udp)
+        {
+          clients.Get (i)->SetAttribute ("MaxPackets", UintegerValue (1));
+        }
+      else
+        {
+          clients.Get (i)->SetAttribute ("MaxBytes", UintegerValue (1));
+        }
+    }
+}
+
+// Bytes recebidos pelos servidores desde o início da simulação
+static uint64_t
+GetReceivedBytes (const SweepConfig &config, const SweepTopology &topology)
+{
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < topology.servers.GetN (); i++)
+    {
+      if (config.udp)
+        {
+          bytes += topology.payloadSize * DynamicCast<UdpServer> (topology.servers.Get (i))->GetReceived ();
+        }
+      else
+        {
+          bytes += DynamicCast<PacketSink> (topology.servers.Get (i))->GetTotalRx ();
+        }
+    }
+  return bytes;
+}
+
+static void
+RecordReceivedBytes (const SweepConfig *config, const SweepTopology *topology, uint64_t *rxBytes)
+{
+  *rxBytes = GetReceivedBytes (*config, *topology);
+}
+
+// Amostragem da vazão de um ponto com convergenceTarget > 0
+struct ConvergenceMonitor
+{
+  const SweepConfig *config;
+  const SweepTopology *topology;
+  std::vector<double> windows; // bytes recebidos em cada janela de 'batchTime'
+  uint64_t lastBytes; // bytes recebidos até a última janela
+  double mean; // bytes por janela, após o descarte do transiente
+  bool converged;
+  EventId sampleEvent;
+};
+
+static void
+SampleConvergence (ConvergenceMonitor *monitor)
+{
+  uint64_t bytes = GetReceivedBytes (*monitor->config, *monitor->topology);
+  monitor->windows.push_back (bytes - monitor->lastBytes);
+  monitor->lastBytes = bytes;
+  const SweepConfig &config = *monitor->config;
+  if (IsSteadyState (monitor->windows, config.convergenceTarget, config.minBatches, monitor->mean))
+    {
+      monitor->converged = true;
+      Simulator::Stop ();
+      return;
+    }
+  monitor->sampleEvent = Simulator::Schedule (Seconds (config.batchTime), &SampleConvergence, monitor);
+}
+
+// Início da amostragem, junto com o início do cliente
+static void
+StartConvergence (ConvergenceMonitor *monitor)
+{
+  monitor->lastBytes = GetReceivedBytes (*monitor->config, *monitor->topology);
+  monitor->sampleEvent = Simulator::Schedule (Seconds (monitor->config->batchTime), &SampleConvergence, monitor);
+}
+
+// Limite de duração de um ponto que pode terminar antes por convergência. Ao contrário de
+// Simulator::Stop (Time), o evento pode ser cancelado quando o ponto converge.
+static void
+StopSimulation (void)
+{
+  Simulator::Stop ();
+}
+
+// Atribui números fixos aos fluxos aleatórios dos dispositivos, do canal, das pilhas IP e
+// das aplicações, que passam a usar a execução atual (RngSeedManager::SetRun). Chamado a
+// cada ponto, faz com que as variáveis aleatórias de um ponto dependam apenas do seu
+// próprio número de execução, e não da posição do ponto no bloco do modo de reuso.
+static void
+AssignSweepStreams (const SweepTopology &topology, const ApplicationContainer &clients)
+{
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < topology.staDevices.size (); i++)
+    {
+      devices.Add (topology.staDevices[i]);
+    }
+  devices.Add (topology.apDevice);
+  NodeContainer nodes = topology.wifiApNode;
+  nodes.Add (topology.wifiStaNode);
+
+  int64_t stream = 0;
+  WifiHelper wifi;
+  stream += wifi.AssignStreams (devices, stream);
+  stream += DynamicCast<YansWifiChannel> (topology.apDevice->GetChannel ())->AssignStreams (stream);
+  InternetStackHelper stack;
+  stream += stack.AssignStreams (nodes, stream);
+  for (uint32_t i = 0; i < clients.GetN (); i++)
+    {
+      Ptr<OnOffApplication> onoff = DynamicCast<OnOffApplication> (clients.Get (i));
+      if (onoff != 0)
+        {
+          stream += onoff->AssignStreams (stream);
+        }
+    }
+}
+
+// Reconstrói o estado que 'local' guarda sobre cada dispositivo de 'remotes' (largura de
+// canal, GI e capacidades HT/VHT/HE), como se a associação tivesse acabado de acontecer
+// com a configuração atual da PHY.
+static void
+RefreshRemoteStations (Ptr<WifiNetDevice> local, const std::vector<Ptr<WifiNetDevice> > &remotes, bool vhtSupported)
+{
+  Ptr<WifiRemoteStationManager> manager = local->GetRemoteStationManager ();
+  manager->Reset ();
+  for (uint32_t i = 0; i < remotes.size (); i++)
+    {
+      Ptr<RegularWifiMac> remoteMac = DynamicCast<RegularWifiMac> (remotes[i]->GetMac ());
+      Mac48Address address = remoteMac->GetAddress ();
+      manager->AddStationHtCapabilities (address, remoteMac->GetHtCapabilities ());
+      if (vhtSupported)
+        {
+          manager->AddStationVhtCapabilities (address, remoteMac->GetVhtCapabilities ());
+        }
+      manager->AddStationHeCapabilities (address, remoteMac->GetHeCapabilities ());
+      manager->RecordGotAssocTxOk (address);
+    }
+}
+
+// Aplica o MCS, a largura do canal e o GI de um novo ponto à topologia existente
+static void
+ConfigureSweepPoint (const SweepConfig &config, const SweepTopology &topology, const SweepPoint &point)
+{
+  std::ostringstream oss;
+  oss << "HeMcs" << point.mcs;
+  std::vector<Ptr<WifiNetDevice> > devices = topology.staDevices;
+  devices.push_back (topology.apDevice);
+  for (uint32_t i = 0; i < devices.size (); i++)
+    {
+      devices[i]->GetPhy ()->SetAttribute ("GuardInterval", TimeValue (NanoSeconds (point.gi)));
+      devices[i]->GetPhy ()->SetAttribute ("ChannelWidth", UintegerValue (point.channelWidth));
+      devices[i]->GetRemoteStationManager ()->SetAttribute ("DataMode", StringValue (oss.str ()));
+      devices[i]->GetRemoteStationManager ()->SetAttribute ("ControlMode", StringValue (oss.str ()));
+    }
+  RefreshRemoteStations (topology.apDevice, topology.staDevices, config.frequency == 5.0);
+  for (uint32_t i = 0; i < topology.staDevices.size (); i++)
+    {
+      RefreshRemoteStations (topology.staDevices[i], std::vector<Ptr<WifiNetDevice> > (1, topology.apDevice), config.frequency == 5.0);
+    }
+}
+
+// Identificação de um ponto nas saídas do perfil de execução
+static std::string
+GetPointLabel (const SweepPoint &point)
+{
+  std::ostringstream oss;
+  oss << "mcs=" << point.mcs << " width=" << point.channelWidth << " gi=" << point.gi << " run=" << point.run
+      << (point.udp ? " udp" : " tcp");
+  return oss.str ();
+}
+
+// Vazão simulada de um ponto, "failed" se o processo falhou ou "-" se não foi simulado
+static void
+PrintThroughputCell (const SweepResult &result)
+{
+  if (result.failed)
+    {
+      std::cout << "failed";
+    }
+  else if (result.simulated)
+    {
+      std::cout << result.throughput << " Mbit/s";
+    }
+  else
+    {
+      std::cout << "-";
+    }
+}
+
+// Imprime uma linha da tabela de resultados; com 'showLatency' acrescenta os percentis
+// de atraso e de jitter, com 'showEstimate' a coluna da estimativa analítica, e marca
+// com "-" os valores dos pontos que não foram simulados
+static void
+PrintSweepRow (const SweepPoint &point, const SweepResult &result, bool showLatency, bool showEstimate)
+{
+  std::cout << point.mcs << "\t\t\t" << point.channelWidth << " MHz\t\t\t" << point.gi << " ns\t\t\t";
+  PrintThroughputCell (result);
+  if (showLatency && result.simulated)
+    {
+      std::cout << "\t\t" << result.latency[0] << "/" << result.latency[1] << "/" << result.latency[2] << " ms"
+                << "\t\t" << result.jitter[0] << "/" << result.jitter[1] << "/" << result.jitter[2] << " ms";
+    }
+  else if (showLatency)
+    {
+      std::cout << "\t\t-\t\t-";
+    }
+  if (showEstimate)
+    {
+      std::cout << "\t\t\t" << result.estimate << " Mbit/s";
+    }
+  if (result.simulated && !result.stations.empty ())
+    {
+      // Modo denso: vazão por direção, justiça e atraso de cada direção (p50/p99/p999)
+      const DenseMetrics &dense = result.dense;
+      std::cout << "\t\t" << dense.downlink << "/" << dense.uplink << " Mbit/s\t\t" << dense.fairness
+                << "\t\t" << dense.latency[0][0] << "/" << dense.latency[0][1] << "/" << dense.latency[0][2] << " ms"
+                << "\t\t" << dense.latency[1][0] << "/" << dense.latency[1][1] << "/" << dense.latency[1][2] << " ms";
+    }
+  std::cout << std::endl;
+}
+
+// Imprime uma linha da tabela do modo duplo: vazão UDP, vazão TCP e a razão TCP/UDP
+static void
+PrintDualRow (const SweepPoint &point, const SweepResult &udpResult, const SweepResult &tcpResult, bool showEstimate)
+{
+  std::cout << point.mcs << "\t\t\t" << point.channelWidth << " MHz\t\t\t" << point.gi << " ns\t\t\t";
+  PrintThroughputCell (udpResult);
+  std::cout << "\t\t";
+  PrintThroughputCell (tcpResult);
+  std::cout << "\t\t";
+  if (udpResult.simulated && tcpResult.simulated && udpResult.throughput > 0)
+    {
+      std::cout << tcpResult.throughput / udpResult.throughput;
+    }
+  else
+    {
+      std::cout << "-";
+    }
+  if (showEstimate)
+    {
+      std::cout << "\t\t\t" << udpResult.estimate << "/" << tcpResult.estimate << " Mbit/s";
+    }
+  std::cout << std::endl;
+}
+
+// Acrescenta a 'records' os contadores de cada fluxo acumulados desde a chamada anterior.
+// No modo de reuso o FlowMonitor continua ativo entre os pontos, por isso 'previous'
+// guarda os totais já atribuídos aos pontos anteriores.
+static void
+CollectFlowRecords (Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier, const SweepPoint &point,
+                    std::map<FlowMonitor::FlowId, FlowRecord> &previous, std::vector<FlowRecord> &records)
+{
+  monitor->CheckForLostPackets ();
+  const FlowMonitor::FlowStatsContainer &stats = monitor->GetFlowStats ();
+  for (FlowMonitor::FlowStatsContainer::const_iterator i = stats.begin (); i != stats.end (); i++)
+    {
+      Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow (i->first);
+      FlowRecord total;
+      std::memset (&total, 0, sizeof (total));
+      total.mcs = point.mcs;
+      total.channelWidth = point.channelWidth;
+      total.gi = point.gi;
+      total.flowId = i->first;
+      total.sourceAddress = tuple.sourceAddress.Get ();
+      total.destinationAddress = tuple.destinationAddress.Get ();
+      total.sourcePort = tuple.sourcePort;
+      total.destinationPort = tuple.destinationPort;
+      total.protocol = tuple.protocol;
+      total.txBytes = i->second.txBytes;
+      total.rxBytes = i->second.rxBytes;
+      total.txPackets = i->second.txPackets;
+      total.rxPackets = i->second.rxPackets;
+      total.lostPackets = i->second.lostPackets;
+      total.timesForwarded = i->second.timesForwarded;
+      total.delaySum = i->second.delaySum.GetNanoSeconds ();
+      total.jitterSum = i->second.jitterSum.GetNanoSeconds ();
+
+      FlowRecord record = total;
+      std::map<FlowMonitor::FlowId, FlowRecord>::const_iterator last = previous.find (i->first);
+      if (last != previous.end ())
+        {
+          record.txBytes -= last->second.txBytes;
+          record.rxBytes -= last->second.rxBytes;
+          record.txPackets -= last->second.txPackets;
+          record.rxPackets -= last->second.rxPackets;
+          record.lostPackets -= last->second.lostPackets;
+          record.timesForwarded -= last->second.timesForwarded;
+          record.delaySum -= last->second.delaySum;
+          record.jitterSum -= last->second.jitterSum;
+        }
+      previous[i->first] = total;
+      if (record.txPackets > 0 || record.rxPackets > 0)
+        {
+          records.push_back (record);
+        }
+    }
+}
+
+// Guarda em 'start' os totais de cada fluxo no início do tráfego de um ponto (1 s após a
+// instalação do cliente), para que as vazões do modo denso não incluam a preparação
+static void
+RecordFlowCounters (Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier, const SweepPoint *point,
+                    std::map<FlowMonitor::FlowId, FlowRecord> *start)
+{
+  std::vector<FlowRecord> records;
+  start->clear ();
+  CollectFlowRecords (monitor, classifier, *point, *start, records);
+}
+
+// Vazões e justiça do modo denso a partir dos contadores 'records' do ponto, acumulados
+// desde o início do tráfego (ver RecordFlowCounters). Os fluxos de dados são os destinados à porta dos servidores (os
+// demais são ACKs do TCP); a vazão de cada um desconta os cabeçalhos IPv4 e UDP/TCP dos
+// bytes recebidos e é dividida por 'duration', o tempo de tráfego do ponto.
+static void
+ComputeDenseMetrics (const SweepConfig &config, const SweepTopology &topology,
+                     const std::vector<FlowRecord> &records, double duration, SweepResult &result)
+{
+  uint16_t port = config.udp ? 9 : 50000;
+  uint32_t headers = 20 + (config.udp ? 8 : 32); // IPv4 e UDP ou TCP com timestamps
+  uint32_t apAddress = topology.apAddress.Get ();
+  std::map<uint32_t, uint32_t> stationIndex; // endereço IPv4 -> índice da STA
+  for (uint32_t i = 0; i < topology.staAddresses.size (); i++)
+    {
+      stationIndex[topology.staAddresses[i].Get ()] = i;
+    }
+
+  result.stations.assign (2 * topology.staAddresses.size (), 0);
+  for (std::size_t i = 0; i < records.size (); i++)
+    {
+      const FlowRecord &record = records[i];
+      if (record.destinationPort != port)
+        {
+          continue;
+        }
+      bool uplink = record.destinationAddress == apAddress;
+      std::map<uint32_t, uint32_t>::const_iterator station = stationIndex.find (uplink ? record.sourceAddress : record.destinationAddress);
+      if (station == stationIndex.end ())
+        {
+          continue;
+        }
+      double goodput = (record.rxBytes - static_cast<uint64_t> (record.rxPackets) * headers) * 8 / (duration * 1000000.0); //Mbit/s
+      result.stations[2 * station->second + uplink] += goodput;
+      if (uplink)
+        {
+          result.dense.uplink += goodput;
+        }
+      else
+        {
+          result.dense.downlink += goodput;
+        }
+    }
+
+  // Índice de Jain: (soma x)^2 / (n * soma x^2), com x a vazão total de cada estação
+  double sum = 0;
+  double squares = 0;
+  for (uint32_t i = 0; i < topology.staAddresses.size (); i++)
+    {
+      double x = result.stations[2 * i] + result.stations[2 * i + 1];
+      sum += x;
+      squares += x * x;
+    }
+  result.dense.fairness = squares > 0 ? sum * sum / (topology.staAddresses.size () * squares) : 0;
+}
+
+// Codifica um resultado para envio do processo filho ao processo principal
+static void
+SerializeSweepResult (const SweepResult &result, std::string &buffer)
+{
+  uint32_t nFlows = result.flows.size ();
+  buffer.append (reinterpret_cast<const char *> (&result.throughput), sizeof (result.throughput));
+  buffer.append (reinterpret_cast<const char *> (result.latency), sizeof (result.latency));
+  buffer.append (reinterpret_cast<const char *> (result.jitter), sizeof (result.jitter));
+  buffer.append (reinterpret_cast<const char *> (&nFlows), sizeof (nFlows));
+  if (nFlows > 0)
+    {
+      buffer.append (reinterpret_cast<const char *> (&result.flows[0]), nFlows * sizeof (FlowRecord));
+    }
+  uint32_t nStations = result.stations.size ();
+  buffer.append (reinterpret_cast<const char *> (&result.dense), sizeof (result.dense));
+  buffer.append (reinterpret_cast<const char *> (&nStations), sizeof (nStations));
+  if (nStations > 0)
+    {
+      buffer.append (reinterpret_cast<const char *> (&result.stations[0]), nStations * sizeof (double));
+    }
+}
+
+// Decodifica um resultado a partir de 'offset'; retorna falso se os dados estiverem incompletos
+static bool
+DeserializeSweepResult (const std::string &buffer, std::size_t &offset, SweepResult &result)
+{
+  uint32_t nFlows = 0;
+  if (buffer.size () < offset + sizeof (result.throughput) + sizeof (result.latency) + sizeof (result.jitter) + sizeof (nFlows))
+    {
+      return false;
+    }
+  std::memcpy (&result.throughput, buffer.data () + offset, sizeof (result.throughput));
+  offset += sizeof (result.throughput);
+  std::memcpy (result.latency, buffer.data () + offset, sizeof (result.latency));
+  offset += sizeof (result.latency);
+  std::memcpy (result.jitter, buffer.data () + offset, sizeof (result.jitter));
+  offset += sizeof (result.jitter);
+  std::memcpy (&nFlows, buffer.data () + offset, sizeof (nFlows));
+  offset += sizeof (nFlows);
+  if (buffer.size () < offset + nFlows * sizeof (FlowRecord))
+    {
+      return false;
+    }
+  result.flows.resize (nFlows);
+  if (nFlows > 0)
+    {
+      std::memcpy (&result.flows[0], buffer.data () + offset, nFlows * sizeof (FlowRecord));
+    }
+  offset += nFlows * sizeof (FlowRecord);
+  uint32_t nStations = 0;
+  if (buffer.size () < offset + sizeof (result.dense) + sizeof (nStations))
+    {
+      return false;
+    }
+  std::memcpy (&result.dense, buffer.data () + offset, sizeof (result.dense));
+  offset += sizeof (result.dense);
+  std::memcpy (&nStations, buffer.data () + offset, sizeof (nStations));
+  offset += sizeof (nStations);
+  if (buffer.size () < offset + nStations * sizeof (double))
+    {
+      return false;
+    }
+  result.stations.resize (nStations);
+  if (nStations > 0)
+    {
+      std::memcpy (&result.stations[0], buffer.data () + offset, nStations * sizeof (double));
+    }
+  offset += nStations * sizeof (double);
+  return true;
+}
+
+// Envia pelo pipe 'fd' o resultado do ponto 'index', precedido da sua posição na tabela,
+// assim que o ponto termina; encerra o processo filho se o pipe falhar
+static void
+SendSweepResult (int fd, std::size_t index, const SweepResult &result)
+{
+  uint64_t position = index;
+  std::string buffer (reinterpret_cast<const char *> (&position), sizeof (position));
+  SerializeSweepResult (result, buffer);
+  const char *data = buffer.data ();
+  std::size_t size = buffer.size ();
+  while (size > 0)
+    {
+      ssize_t n = write (fd, data, size);
+      if (n < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (n <= 0)
+        {
+          _exit (1);
+        }
+      data += n;
+      size -= n;
+    }
+}
+
+// Registro durável dos pontos concluídos. Cada ponto é acrescentado ao arquivo assim que
+// termina (seguido de fsync), com o hash da configuração, a identificação do ponto e o
+// resultado codificado. Ao retomar uma varredura, os pontos registrados com o mesmo hash
+// não são simulados novamente. Um registro incompleto no final do arquivo (processo
+// interrompido durante a escrita) é descartado.
+class SweepJournal
+{
+public:
+  SweepJournal (const std::string &fileName, uint64_t configHash);
+  ~SweepJournal ();
+
+  bool Find (const SweepPoint &point, SweepResult &result) const;
+  void Record (const SweepPoint &point, const SweepResult &result);
+
+private:
+  static std::string GetKey (const SweepPoint &point);
+
+  int m_fd;
+  uint64_t m_configHash;
+  std::map<std::string, SweepResult> m_completed;
+};
+
+static const char g_journalMagic[8] = { 'H', 'E', 'J', 'R', 'N', 'L', '0', '4' };
+
+SweepJournal::SweepJournal (const std::string &fileName, uint64_t configHash)
+  : m_configHash (configHash)
+{
+  m_fd = open (fileName.c_str (), O_RDWR | O_CREAT, 0644);
+  if (m_fd < 0)
+    {
+      NS_FATAL_ERROR ("Cannot open journal " << fileName << ": " << std::strerror (errno));
+    }
+  std::string data;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = read (m_fd, buffer, sizeof (buffer))) > 0)
+    {
+      data.append (buffer, n);
+    }
+  if (data.empty ())
+    {
+      if (write (m_fd, g_journalMagic, sizeof (g_journalMagic)) != sizeof (g_journalMagic))
+        {
+          NS_FATAL_ERROR ("Cannot write journal " << fileName << ": " << std::strerror (errno));
+        }
+      return;
+    }
+  if (data.size () < sizeof (g_journalMagic) || std::memcmp (data.data (), g_journalMagic, sizeof (g_journalMagic)) != 0)
+    {
+      NS_FATAL_ERROR (fileName << " is not a sweep journal written by this program");
+    }
+
+  std::size_t offset = sizeof (g_journalMagic);
+  while (true)
+    {
+      uint32_t length = 0;
+      if (data.size () < offset + sizeof (length))
+        {
+          break;
+        }
+      std::memcpy (&length, data.data () + offset, sizeof (length));
+      if (data.size () < offset + sizeof (length) + length)
+        {
+          break;
+        }
+      std::string record = data.substr (offset + sizeof (length), length);
+      uint64_t hash = 0;
+      SweepPoint point;
+      std::size_t position = sizeof (hash) + 4 * sizeof (int32_t) + sizeof (uint32_t);
+      SweepResult result;
+      if (record.size () < position || !DeserializeSweepResult (record, position, result))
+        {
+          break;
+        }
+      std::memcpy (&hash, record.data (), sizeof (hash));
+      std::memcpy (&point.mcs, record.data () + sizeof (hash), sizeof (int32_t));
+      std::memcpy (&point.channelWidth, record.data () + sizeof (hash) + sizeof (int32_t), sizeof (int32_t));
+      std::memcpy (&point.gi, record.data () + sizeof (hash) + 2 * sizeof (int32_t), sizeof (int32_t));
+      int32_t udp = 0;
+      std::memcpy (&udp, record.data () + sizeof (hash) + 3 * sizeof (int32_t), sizeof (int32_t));
+      point.udp = udp != 0;
+      std::memcpy (&point.run, record.data () + sizeof (hash) + 4 * sizeof (int32_t), sizeof (uint32_t));
+      if (hash == m_configHash)
+        {
+          result.estimate = 0;
+          result.simulated = true;
+          result.failed = false;
+          m_completed[GetKey (point)] = result;
+        }
+      offset += sizeof (length) + length;
+    }
+  // Descarta um eventual registro incompleto para que os próximos fiquem alinhados
+  if (offset != data.size ())
+    {
+      NS_LOG_WARN ("Discarding " << data.size () - offset << " bytes of incomplete journal record");
+      if (ftruncate (m_fd, offset) != 0)
+        {
+          NS_FATAL_ERROR ("Cannot truncate journal " << fileName << ": " << std::strerror (errno));
+        }
+    }
+  lseek (m_fd, offset, SEEK_SET);
+}
+
+SweepJournal::~SweepJournal ()
+{
+  close (m_fd);
+}
+
+std::string
+SweepJournal::GetKey (const SweepPoint &point)
+{
+  std::ostringstream oss;
+  oss << point.mcs << "/" << point.channelWidth << "/" << point.gi << "/" << point.run << "/" << point.udp;
+  return oss.str ();
+}
+
+bool
+SweepJournal::Find (const SweepPoint &point, SweepResult &result) const
+{
+  std::map<std::string, SweepResult>::const_iterator i = m_completed.find (GetKey (point));
+  if (i == m_completed.end ())
+    {
+      return false;
+    }
+  result = i->second;
+  return true;
+}
+
+void
+SweepJournal::Record (const SweepPoint &point, const SweepResult &result)
+{
+  std::string record;
+  int32_t fields[4] = { point.mcs, point.channelWidth, point.gi, point.udp };
+  record.append (reinterpret_cast<const char *> (&m_configHash), sizeof (m_configHash));
+  record.append (reinterpret_cast<const char *> (fields), sizeof (fields));
+  record.append (reinterpret_cast<const char *> (&point.run), sizeof (point.run));
+  SerializeSweepResult (result, record);
+  uint32_t length = record.size ();
+  record.insert (0, reinterpret_cast<const char *> (&length), sizeof (length));
+
+  const char *data = record.data ();
+  std::size_t size = record.size ();
+  while (size > 0)
+    {
+      ssize_t n = write (m_fd, data, size);
+      if (n < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (n <= 0)
+        {
+          NS_FATAL_ERROR ("Cannot write journal: " << std::strerror (errno));
+        }
+      data += n;
+      size -= n;
+    }
+  // O ponto só é dado como concluído depois que o registro chega ao disco
+  if (fsync (m_fd) != 0)
+    {
+      NS_FATAL_ERROR ("Cannot sync journal: " << std::strerror (errno));
+    }
+  m_completed[GetKey (point)] = result;
+}
+
+// Tabela de resultados da varredura. Recebe os pontos concluídos em qualquer ordem,
+// registra-os no diário (se houver) e imprime as linhas na ordem original assim que
+// todos os pontos anteriores estiverem concluídos.
+class SweepReport
+{
+public:
+  SweepReport (const std::vector<SweepPoint> &points, bool print, bool showLatency, bool dual, SweepJournal *journal);
+
+  void Complete (std::size_t index, const SweepResult &result, bool record);
+  void Fail (std::size_t index);
+  bool IsDone (std::size_t index) const;
+  bool IsRestored (std::size_t index) const;
+  SweepResult &GetResult (std::size_t index);
+  const std::vector<SweepResult> &GetResults (void) const;
+
+private:
+  void Flush (void);
+
+  const std::vector<SweepPoint> &m_points;
+  std::vector<SweepResult> m_results;
+  std::vector<bool> m_done;
+  std::vector<bool> m_restored; // resultado lido do diário, e não simulado nesta execução
+  std::size_t m_printed; // quantidade de linhas já impressas
+  bool m_print;
+  bool m_showLatency;
+  bool m_dual; // pontos em pares UDP/TCP, impressos juntos em uma única linha
+  SweepJournal *m_journal;
+};
+
+SweepReport::SweepReport (const std::vector<SweepPoint> &points, bool print, bool showLatency, bool dual, SweepJournal *journal)
+  : m_points (points),
+    m_results (points.size ()),
+    m_done (points.size (), false),
+    m_restored (points.size (), false),
+    m_printed (0),
+    m_print (print),
+    m_showLatency (showLatency),
+    m_dual (dual),
+    m_journal (journal)
+{
+  for (std::size_t i = 0; i < m_results.size (); i++)
+    {
+      m_results[i].throughput = 0;
+      std::memset (m_results[i].latency, 0, sizeof (m_results[i].latency));
+      std::memset (m_results[i].jitter, 0, sizeof (m_results[i].jitter));
+      m_results[i].estimate = 0;
+      m_results[i].simulated = false;
+      m_results[i].failed = false;
+      std::memset (&m_results[i].dense, 0, sizeof (m_results[i].dense));
+    }
+}
+
+void
+SweepReport::Complete (std::size_t index, const SweepResult &result, bool record)
+{
+  double estimate = m_results[index].estimate;
+  m_results[index] = result;
+  m_results[index].estimate = estimate;
+  m_results[index].simulated = true;
+  m_results[index].failed = false;
+  m_done[index] = true;
+  m_restored[index] = !record;
+  if (record && m_journal != 0)
+    {
+      m_journal->Record (m_points[index], m_results[index]);
+    }
+  Flush ();
+}
+
+void
+SweepReport::Fail (std::size_t index)
+{
+  m_results[index].simulated = false;
+  m_results[index].failed = true;
+  m_done[index] = true;
+  Flush ();
+}
+
+bool
+SweepReport::IsDone (std::size_t index) const
+{
+  return m_done[index];
+}
+
+bool
+SweepReport::IsRestored (std::size_t index) const
+{
+  return m_restored[index];
+}
+
+SweepResult &
+SweepReport::GetResult (std::size_t index)
+{
+  return m_results[index];
+}
+
+const std::vector<SweepResult> &
+SweepReport::GetResults (void) const
+{
+  return m_results;
+}
+
+void
+SweepReport::Flush (void)
+{
+  std::size_t step = m_dual ? 2 : 1;
+  while (m_printed + step <= m_points.size () && m_done[m_printed] && m_done[m_printed + step - 1])
+    {
+      if (m_print && m_dual)
+        {
+          PrintDualRow (m_points[m_printed], m_results[m_printed], m_results[m_printed + 1], false);
+        }
+      else if (m_print)
+        {
+          PrintSweepRow (m_points[m_printed], m_results[m_printed], m_showLatency, false);
+        }
+      m_printed += step;
+    }
+}
+
+// Simula um lote de pontos sobre uma única topologia: cada ponto reconfigura a PHY e o
+// gerenciador, instala um novo cliente e avança o mesmo simulador por mais
+// 'simulationTime + 1' segundos. A vazão considera apenas os bytes recebidos após o
+// início do cliente, de modo que pacotes remanescentes do ponto anterior (escoados
+// durante o segundo de preparação) não são contabilizados. Se 'report' for informado,
+// cada ponto é entregue a ele assim que termina; se 'resultFd' for um pipe (processo
+// filho), cada ponto é enviado por ele assim que termina. Todos os pontos do lote devem
+// usar o mesmo transporte.
+static std::vector<SweepResult>
+RunSweepBatch (const SweepConfig &sweepConfig, const std::vector<SweepPoint> &points,
+               const std::vector<std::size_t> &indices, SweepReport *report, int resultFd)
+{
+  std::vector<SweepResult> results;
+  if (indices.empty ())
+    {
+      return results;
+    }
+  const SweepConfig config = GetPointConfig (sweepConfig, points[indices[0]]);
+  // Perfil de execução por ponto: a topologia e as rotas são atribuídas ao primeiro
+  // ponto do bloco e o Simulator::Destroy ao último
+  bool profiling = config.profile || !config.profileFile.empty ();
+  RunProfiler profiler (GetPointLabel (points[indices[0]]));
+  if (profiling)
+    {
+      profiler.StartPhase ("topology");
+    }
+
+  RngSeedManager::SetRun (points[indices[0]].run);
+  SweepTopology topology;
+  ConfigScope scope; // restaura os valores padrão ao final do lote, após o Simulator::Destroy
+  BuildSweepTopology (config, points[indices[0]], topology, scope);
+
+  if (profiling)
+    {
+      profiler.StartPhase ("routing");
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // Configura a utilização do monitoramento com Flow Monitor, apenas quando as
+  // estatísticas por fluxo foram pedidas ou no modo denso. Os histogramas não são usados,
+  // por isso cada um fica reduzido a uma única classe.
+  bool dense = config.nStations > 1;
+  Ptr<FlowMonitor> flowMonitor;
+  FlowMonitorHelper flowHelper;
+  std::map<FlowMonitor::FlowId, FlowRecord> previousFlows;
+  std::map<FlowMonitor::FlowId, FlowRecord> trafficStartFlows; // totais no início do tráfego do ponto
+  if (config.flowStats || dense)
+    {
+      flowHelper.SetMonitorAttribute ("DelayBinWidth", DoubleValue (3600));
+      flowHelper.SetMonitorAttribute ("JitterBinWidth", DoubleValue (3600));
+      flowHelper.SetMonitorAttribute ("PacketSizeBinWidth", DoubleValue (65536));
+      flowHelper.SetMonitorAttribute ("FlowInterruptionsBinWidth", DoubleValue (3600));
+      flowMonitor = flowHelper.InstallAll();
+    }
+
+  // Atraso e jitter medidos nos servidores: [0] os das STAs (descida) e [1] o do AP,
+  // instalado por último no modo denso (subida)
+  LatencyMonitor latencyMonitors[2];
+  if (config.latency)
+    {
+      for (uint32_t i = 0; i < topology.servers.GetN (); i++)
+        {
+          LatencyMonitor &latencyMonitor = latencyMonitors[dense && i == config.nStations];
+          if (config.udp)
+            {
+              latencyMonitor.ConnectUdpServer (topology.servers.Get (i));
+            }
+          else
+            {
+              latencyMonitor.ConnectPacketSink (topology.servers.Get (i));
+            }
+        }
+    }
+
+  for (std::size_t i = 0; i < indices.size (); i++)
+    {
+      const SweepPoint &point = points[indices[i]];
+      if (profiling)
+        {
+          if (i > 0)
+            {
+              profiler = RunProfiler (GetPointLabel (point));
+            }
+          profiler.StartPhase ("client");
+        }
+      // Cada ponto usa o seu próprio número de execução, também no modo de reuso: o
+      // resultado registrado no diário sob 'point.run' não depende do bloco do ponto
+      RngSeedManager::SetRun (point.run);
+      if (i > 0)
+        {
+          ConfigureSweepPoint (config, topology, point);
+        }
+      ApplicationContainer clients = InstallSweepClient (config, topology);
+      AssignSweepStreams (topology, clients);
+      uint64_t rxStart = 0;
+      Simulator::Schedule (Seconds (1.0), &RecordReceivedBytes, &config, &topology, &rxStart);
+      if (dense)
+        {
+          Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
+          Simulator::Schedule (Seconds (1.0), &RecordFlowCounters, flowMonitor, classifier, &point, &trafficStartFlows);
+        }
+      if (config.latency)
+        {
+          // Sem o SeqTsHeader do UDP, o instante de envio segue nos byte tags
+          for (uint32_t c = 0; !config.udp && c < clients.GetN (); c++)
+            {
+              LatencyMonitor::TagTcpSource (clients.Get (c));
+            }
+          // Descarta os pacotes remanescentes do ponto anterior
+          Simulator::Schedule (Seconds (1.0), &LatencyMonitor::Reset, &latencyMonitors[0]);
+          Simulator::Schedule (Seconds (1.0), &LatencyMonitor::Reset, &latencyMonitors[1]);
+        }
+      ConvergenceMonitor monitor;
+      monitor.config = &config;
+      monitor.topology = &topology;
+      monitor.lastBytes = 0;
+      monitor.mean = 0;
+      monitor.converged = false;
+      EventId stopEvent;
+      if (config.convergenceTarget > 0)
+        {
+          Simulator::Schedule (Seconds (1.0), &StartConvergence, &monitor);
+          stopEvent = Simulator::Schedule (Seconds (config.simulationTime + 1), &StopSimulation);
+        }
+      else
+        {
+          Simulator::Stop (Seconds (config.simulationTime + 1));
+        }
+      if (profiling)
+        {
+          profiler.StartPhase ("run");
+        }
+      Simulator::Run ();
+      if (profiling)
+        {
+          profiler.StartPhase ("extract");
+        }
+
+      Simulator::Cancel (monitor.sampleEvent);
+      SweepResult result;
+      std::memset (&result.dense, 0, sizeof (result.dense));
+      std::memset (result.latency, 0, sizeof (result.latency));
+      std::memset (result.jitter, 0, sizeof (result.jitter));
+      double duration = config.simulationTime; // tempo de tráfego do ponto
+      if (monitor.converged)
+        {
+          Simulator::Cancel (stopEvent);
+          HaltSweepClient (config, clients);
+          duration = monitor.windows.size () * config.batchTime;
+          result.throughput = (monitor.mean * 8) / (config.batchTime * 1000000.0); //Mbit/s
+          NS_LOG_INFO ("MCS " << point.mcs << " convergiu após " << monitor.windows.size () * config.batchTime << " s");
+        }
+      else
+        {
+          uint64_t rxBytes = GetReceivedBytes (config, topology) - rxStart;
+          result.throughput = (rxBytes * 8) / (config.simulationTime * 1000000.0); //Mbit/s
+        }
+      result.estimate = 0;
+      result.simulated = true;
+      result.failed = false;
+      if (config.latency)
+        {
+          static const double quantiles[3] = { 0.50, 0.99, 0.999 };
+          QuantileSketch latency;
+          QuantileSketch jitter;
+          for (uint32_t direction = 0; direction < 2; direction++)
+            {
+              QuantileSketch directionLatency;
+              QuantileSketch directionJitter;
+              latencyMonitors[direction].Summarize (directionLatency, directionJitter);
+              for (uint32_t q = 0; q < 3; q++)
+                {
+                  result.dense.latency[direction][q] = dense ? directionLatency.GetQuantile (quantiles[q]) * 1000 : 0; //ms
+                }
+              latency.Merge (directionLatency);
+              jitter.Merge (directionJitter);
+            }
+          for (uint32_t q = 0; q < 3; q++)
+            {
+              result.latency[q] = latency.GetQuantile (quantiles[q]) * 1000; //ms
+              result.jitter[q] = jitter.GetQuantile (quantiles[q]) * 1000; //ms
+            }
+        }
+      if (flowMonitor != 0)
+        {
+          Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowHelper.GetClassifier ());
+          std::vector<FlowRecord> records;
+          CollectFlowRecords (flowMonitor, classifier, point, previousFlows, records);
+          if (dense)
+            {
+              std::vector<FlowRecord> trafficRecords;
+              CollectFlowRecords (flowMonitor, classifier, point, trafficStartFlows, trafficRecords);
+              ComputeDenseMetrics (config, topology, trafficRecords, duration, result);
+            }
+          if (config.flowStats)
+            {
+              result.flows.swap (records);
+            }
+        }
+      results.push_back (result);
+      if (report != 0)
+        {
+          report->Complete (indices[i], result, true);
+        }
+      if (resultFd >= 0)
+        {
+          SendSweepResult (resultFd, indices[i], result);
+        }
+      if (profiling && i + 1 < indices.size ())
+        {
+          profiler.Stop ();
+          profiler.Report (config.profile, config.profileFile);
+        }
+    }
+
+  if (profiling)
+    {
+      profiler.StartPhase ("destroy");
+    }
+  Simulator::Destroy ();
+  if (profiling)
+    {
+      profiler.Stop ();
+      profiler.Report (config.profile, config.profileFile);
+    }
+
+  return results;
+}
+
+// Simula os pontos 'indices' neste processo. Sem reuso, cada ponto tem sua própria
+// topologia e seu próprio número de execução; com reuso, todos compartilham a topologia.
+// 'report' e 'resultFd' são repassados a RunSweepBatch (-1: sem pipe).
+static std::vector<SweepResult>
+RunSweepPoints (const SweepConfig &config, const std::vector<SweepPoint> &points,
+                const std::vector<std::size_t> &indices, SweepReport *report, int resultFd)
+{
+  if (config.reuseTopology)
+    {
+      // Os servidores dependem do transporte: no modo duplo, uma topologia por transporte
+      std::vector<std::size_t> batches[2];
+      for (std::size_t i = 0; i < indices.size (); i++)
+        {
+          batches[points[indices[i]].udp].push_back (indices[i]);
+        }
+      std::map<std::size_t, SweepResult> completed;
+      for (uint32_t udp = 0; udp < 2; udp++)
+        {
+          std::vector<SweepResult> batchResults = RunSweepBatch (config, points, batches[udp], report, resultFd);
+          for (std::size_t i = 0; i < batchResults.size (); i++)
+            {
+              completed[batches[udp][i]] = batchResults[i];
+            }
+        }
+      std::vector<SweepResult> results;
+      for (std::size_t i = 0; i < indices.size (); i++)
+        {
+          results.push_back (completed[indices[i]]);
+        }
+      return results;
+    }
+  std::vector<SweepResult> results;
+  for (std::size_t i = 0; i < indices.size (); i++)
+    {
+      std::vector<std::size_t> single (1, indices[i]);
+      results.push_back (RunSweepBatch (config, points, single, report, resultFd)[0]);
+    }
+  return results;
+}
+
+// Cria um processo filho que simula os pontos 'indices' e envia cada resultado pelo pipe
+// assim que o ponto termina
+static void
+StartSweepWorker (const SweepConfig &config, const std::vector<SweepPoint> &points,
+                  const std::vector<std::size_t> &indices, std::vector<SweepWorker> &workers)
+{
+  int fds[2];
+  if (pipe (fds) != 0)
+    {
+      NS_FATAL_ERROR ("pipe () failed: " << std::strerror (errno));
+    }
+  // Esvazia o buffer de saída para que o filho não imprima linhas duplicadas
+  std::cout.flush ();
+  pid_t pid = fork ();
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("fork () failed: " << std::strerror (errno));
+    }
+  if (pid == 0)
+    {
+      close (fds[0]);
+      RunSweepPoints (config, points, indices, 0, fds[1]);
+      close (fds[1]);
+      _exit (0);
+    }
+  close (fds[1]);
+  SweepWorker worker;
+  worker.pid = pid;
+  worker.fd = fds[0];
+  worker.indices = indices;
+  workers.push_back (worker);
+}
+
+// Entrega a 'report' (e, com ele, ao diário) cada resultado completo já recebido do
+// filho, no momento em que chega; os bytes de um resultado incompleto ficam em 'data'
+static void
+ReceiveSweepResults (SweepWorker &worker, SweepReport &report)
+{
+  std::size_t offset = 0;
+  while (true)
+    {
+      std::size_t start = offset;
+      uint64_t position;
+      SweepResult result;
+      if (worker.data.size () < offset + sizeof (position))
+        {
+          break;
+        }
+      std::memcpy (&position, worker.data.data () + offset, sizeof (position));
+      offset += sizeof (position);
+      if (!DeserializeSweepResult (worker.data, offset, result))
+        {
+          offset = start;
+          break;
+        }
+      report.Complete (position, result, true);
+    }
+  worker.data.erase (0, offset);
+}
+
+// Encerra um filho que fechou o pipe. Os pontos que o filho não chegou a entregar (por
+// exemplo, se ele foi interrompido) são marcados como falhos, e a varredura continua
+// com os demais.
+static void
+FinishSweepWorker (SweepWorker &worker, const std::vector<SweepPoint> &points, SweepReport &report)
+{
+  close (worker.fd);
+  int status = 0;
+  while (waitpid (worker.pid, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+  bool exited = WIFEXITED (status) && WEXITSTATUS (status) == 0;
+  ReceiveSweepResults (worker, report);
+  for (std::size_t i = 0; i < worker.indices.size (); i++)
+    {
+      if (report.IsDone (worker.indices[i]))
+        {
+          continue;
+        }
+      const SweepPoint &point = points[worker.indices[i]];
+      std::cerr << "Worker for MCS " << point.mcs << ", " << point.channelWidth << " MHz, "
+                << point.gi << " ns failed" << (exited ? "" : " (abnormal exit)") << std::endl;
+      report.Fail (worker.indices[i]);
+    }
+}
+
+// Executa os pontos 'pending' da varredura. Com 'maxWorkers' <= 1 os pontos são
+// simulados em sequência neste processo; caso contrário, são simulados em processos
+// filhos, com no máximo 'maxWorkers' processos simultâneos: um ponto por filho ou, no
+// modo de reuso, um bloco contíguo de pontos por filho. Os resultados são entregues a
+// 'report' à medida que os pontos terminam.
+static void
+RunSweep (const SweepConfig &config, const std::vector<SweepPoint> &points,
+          const std::vector<std::size_t> &pending, uint32_t maxWorkers, SweepReport &report)
+{
+  if (maxWorkers <= 1)
+    {
+      RunSweepPoints (config, points, pending, &report, -1);
+      return;
+    }
 
-using namespace ns3;
+  // Divide os pontos em lotes: blocos contíguos de tamanho equilibrado no modo de reuso.
+  // No modo duplo cada transporte tem seus próprios blocos, que dividem os processos.
+  std::vector<std::vector<std::size_t> > groups (config.dual && config.reuseTopology ? 2 : 1);
+  for (std::size_t i = 0; i < pending.size (); i++)
+    {
+      groups[groups.size () == 2 ? points[pending[i]].udp : 0].push_back (pending[i]);
+    }
+  std::vector<std::vector<std::size_t> > batches;
+  for (std::size_t g = 0; g < groups.size (); g++)
+    {
+      const std::vector<std::size_t> &group = groups[g];
+      std::size_t groupWorkers = std::max<std::size_t> (1, maxWorkers / groups.size ());
+      std::size_t nBatches = config.reuseTopology ? std::min<std::size_t> (groupWorkers, group.size ()) : group.size ();
+      for (std::size_t b = 0; b < nBatches; b++)
+        {
+          std::vector<std::size_t> batch;
+          for (std::size_t i = b * group.size () / nBatches; i < (b + 1) * group.size () / nBatches; i++)
+            {
+              batch.push_back (group[i]);
+            }
+          batches.push_back (batch);
+        }
+    }
 
-// Definição do componente de log: he-wifi-network
-NS_LOG_COMPONENT_DEFINE ("he-wifi-network");
+  std::vector<SweepWorker> workers;
+  std::size_t next = 0; // próximo lote a ser iniciado
+  while (next < batches.size () || !workers.empty ())
+    {
+      while (next < batches.size () && workers.size () < maxWorkers)
+        {
+          StartSweepWorker (config, points, batches[next], workers);
+          next++;
+        }
+
+      std::vector<struct pollfd> fds (workers.size ());
+      for (std::size_t i = 0; i < workers.size (); i++)
+        {
+          fds[i].fd = workers[i].fd;
+          fds[i].events = POLLIN;
+          fds[i].revents = 0;
+        }
+      if (poll (&fds[0], fds.size (), -1) < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("poll () failed: " << std::strerror (errno));
+        }
+
+      // Percorre de trás para frente para poder remover os filhos concluídos
+      for (std::size_t i = workers.size (); i-- > 0; )
+        {
+          if (fds[i].revents == 0)
+            {
+              continue;
+            }
+          char buffer[4096];
+          ssize_t n = read (workers[i].fd, buffer, sizeof (buffer));
+          if (n > 0)
+            {
+              workers[i].data.append (buffer, n);
+              ReceiveSweepResults (workers[i], report);
+              continue;
+            }
+          if (n < 0 && errno == EINTR)
+            {
+              continue;
+            }
+          FinishSweepWorker (workers[i], points, report);
+          workers.erase (workers.begin () + i);
+        }
+    }
+}
+
+// Hash FNV-1a de 64 bits da descrição textual da configuração, usado para reconhecer no
+// diário os pontos simulados com exatamente os mesmos parâmetros
+static uint64_t
+GetConfigHash (const SweepConfig &config)
+{
+  std::ostringstream oss;
+  oss.precision (17);
+  oss << "he-wifi-network/1 udp=" << config.udp << " simulationTime=" << config.simulationTime
+      << " distance=" << config.distance << " frequency=" << config.frequency
+      << " useRts=" << config.useRts << " reuseTopology=" << config.reuseTopology
+      << " saturationSource=" << config.saturationSource << " flowStats=" << config.flowStats
+      << " seed=" << RngSeedManager::GetSeed ();
+  if (config.dual)
+    {
+      oss << " dual=1";
+    }
+  if (config.indexedChannel)
+    {
+      // O piso pode alterar a interferência; sem o canal indexado o hash não muda
+      oss << " rxPowerFloor=" << config.rxPowerFloor;
+    }
+  if (config.nStations > 1 || config.stationRate > 0)
+    {
+      oss << " nStations=" << config.nStations << " stationRate=" << config.stationRate;
+    }
+  if (!config.latency)
+    {
+      // Os resultados registrados sem medição de atraso não servem a uma execução com ela
+      oss << " latency=0";
+    }
+  if (config.convergenceTarget > 0)
+    {
+      oss << " convergenceTarget=" << config.convergenceTarget << " batchTime=" << config.batchTime
+          << " minBatches=" << config.minBatches;
+    }
+  std::string text = oss.str ();
+  uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < text.size (); i++)
+    {
+      hash ^= static_cast<unsigned char> (text[i]);
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+// Acrescenta os registros por fluxo dos pontos simulados nesta execução ao arquivo de
+// estatísticas, em uma única passagem; os pontos lidos do diário ('--resume') ficam de
+// fora, para que não sejam gravados de novo. O cabeçalho é escrito apenas quando o
+// arquivo ainda está vazio.
+static void
+WriteStatsFile (const std::string &fileName, const SweepReport &report)
+{
+  const std::vector<SweepResult> &results = report.GetResults ();
+  std::fstream file (fileName.c_str (), std::ios::in | std::ios::out | std::ios::binary | std::ios::app);
+  if (!file)
+    {
+      NS_FATAL_ERROR ("Cannot open stats file " << fileName);
+    }
+  file.seekg (0, std::ios::end);
+  uint32_t recordSize = sizeof (FlowRecord);
+  if (file.tellg () == std::streampos (0))
+    {
+      file.write (g_statsMagic, sizeof (g_statsMagic));
+      file.write (reinterpret_cast<const char *> (&recordSize), sizeof (recordSize));
+    }
+  else
+    {
+      char magic[sizeof (g_statsMagic)];
+      uint32_t size = 0;
+      file.seekg (0, std::ios::beg);
+      file.read (magic, sizeof (magic));
+      file.read (reinterpret_cast<char *> (&size), sizeof (size));
+      if (!file || std::memcmp (magic, g_statsMagic, sizeof (magic)) != 0 || size != recordSize)
+        {
+          NS_FATAL_ERROR (fileName << " is not a stats file written by this program");
+        }
+      file.clear ();
+    }
+  for (std::size_t i = 0; i < results.size (); i++)
+    {
+      if (!report.IsRestored (i) && !results[i].flows.empty ())
+        {
+          file.write (reinterpret_cast<const char *> (&results[i].flows[0]), results[i].flows.size () * sizeof (FlowRecord));
+        }
+    }
+}
+
+// Grava em CSV a vazão de descida e de subida de cada estação em cada ponto simulado no
+// modo denso
+static void
+WriteStationsFile (const std::string &fileName, const std::vector<SweepPoint> &points,
+                   const std::vector<SweepResult> &results)
+{
+  std::ofstream file (fileName.c_str ());
+  if (!file)
+    {
+      NS_FATAL_ERROR ("Cannot open stations file " << fileName);
+    }
+  file << "mcs,channelWidth,gi,protocol,station,downlink,uplink\n";
+  for (std::size_t i = 0; i < results.size (); i++)
+    {
+      if (!results[i].simulated)
+        {
+          continue;
+        }
+      for (std::size_t j = 0; j + 1 < results[i].stations.size (); j += 2)
+        {
+          file << points[i].mcs << "," << points[i].channelWidth << "," << points[i].gi << ","
+               << (points[i].udp ? "udp" : "tcp") << "," << j / 2
+               << "," << results[i].stations[j] << "," << results[i].stations[j + 1] << "\n";
+        }
+    }
+}
+
+// Converte o arquivo binário de estatísticas para CSV ou para XML no estilo do FlowMonitor
+static void
+ConvertStatsFile (const std::string &fileName, const std::string &format, std::ostream &os)
+{
+  std::ifstream file (fileName.c_str (), std::ios::binary);
+  char magic[sizeof (g_statsMagic)];
+  uint32_t recordSize = 0;
+  file.read (magic, sizeof (magic));
+  file.read (reinterpret_cast<char *> (&recordSize), sizeof (recordSize));
+  if (!file || std::memcmp (magic, g_statsMagic, sizeof (magic)) != 0 || recordSize != sizeof (FlowRecord))
+    {
+      NS_FATAL_ERROR (fileName << " is not a stats file written by this program");
+    }
+  bool xml = format == "xml";
+  if (xml)
+    {
+      os << "<?xml version=\"1.0\" ?>\n<FlowMonitor>\n  <FlowStats>\n";
+    }
+  else
+    {
+      os << "mcs,channelWidth,gi,flowId,source,sourcePort,destination,destinationPort,protocol,"
+         << "txBytes,rxBytes,txPackets,rxPackets,lostPackets,timesForwarded,delaySum,jitterSum\n";
+    }
+  FlowRecord record;
+  while (file.read (reinterpret_cast<char *> (&record), sizeof (record)))
+    {
+      if (xml)
+        {
+          os << "    <Flow flowId=\"" << record.flowId << "\" mcs=\"" << record.mcs
+             << "\" channelWidth=\"" << record.channelWidth << "\" gi=\"" << record.gi
+             << "\" sourceAddress=\"" << Ipv4Address (record.sourceAddress) << "\" sourcePort=\"" << record.sourcePort
+             << "\" destinationAddress=\"" << Ipv4Address (record.destinationAddress)
+             << "\" destinationPort=\"" << record.destinationPort << "\" protocol=\"" << record.protocol
+             << "\" txBytes=\"" << record.txBytes << "\" rxBytes=\"" << record.rxBytes
+             << "\" txPackets=\"" << record.txPackets << "\" rxPackets=\"" << record.rxPackets
+             << "\" lostPackets=\"" << record.lostPackets << "\" timesForwarded=\"" << record.timesForwarded
+             << "\" delaySum=\"" << record.delaySum << "ns\" jitterSum=\"" << record.jitterSum << "ns\" />\n";
+        }
+      else
+        {
+          os << record.mcs << "," << record.channelWidth << "," << record.gi << "," << record.flowId << ","
+             << Ipv4Address (record.sourceAddress) << "," << record.sourcePort << ","
+             << Ipv4Address (record.destinationAddress) << "," << record.destinationPort << "," << record.protocol << ","
+             << record.txBytes << "," << record.rxBytes << "," << record.txPackets << "," << record.rxPackets << ","
+             << record.lostPackets << "," << record.timesForwarded << "," << record.delaySum << "," << record.jitterSum << "\n";
+        }
+    }
+  if (xml)
+    {
+      os << "  </FlowStats>\n</FlowMonitor>\n";
+    }
+}
+
+// Registra uma verificação que falhou
+static void
+ReportCheckFailure (const SweepPoint &point, double throughput, const std::string &reason, uint32_t &failures)
+{
+  std::cerr << "Check failed for " << (point.udp ? "UDP" : "TCP") << " MCS " << point.mcs << ", "
+            << point.channelWidth << " MHz, " << point.gi << " ns: obtained throughput " << throughput << " Mbit/s " << reason << std::endl;
+  failures++;
+}
+
+// Pontos comparados com minExpectedThroughput e maxExpectedThroughput: sempre simulados
+static bool
+IsCheckedCorner (const SweepPoint &point)
+{
+  return (point.mcs == 0 && point.channelWidth == 20 && point.gi == 3200)
+         || (point.mcs == 11 && point.channelWidth == 160 && point.gi == 800);
+}
+
+// Aplica as verificações de consistência sobre a tabela completa, na ordem da varredura,
+// e retorna a quantidade de falhas em vez de interromper na primeira delas.
+// Apenas vazões simuladas são verificadas; pontos cujo processo falhou contam como falha.
+static uint32_t
+CheckSweepResults (const std::vector<SweepPoint> &points, const std::vector<SweepResult> &results,
+                   double minExpectedThroughput, double maxExpectedThroughput, bool checkMonotonicity)
+{
+  uint32_t failures = 0;
+  // Configuração para percorrer os valores de MCS com base nos valores já calculados
+  double prevThroughput [12];
+  for (uint32_t l = 0; l < 12; l++)
+    {
+      prevThroughput[l] = 0;
+    }
+  uint8_t index = 0;
+  double previous = 0;
+  uint32_t unchecked = 0; // pontos não simulados, fora das verificações
+  for (std::size_t i = 0; i < points.size (); i++)
+    {
+      int mcs = points[i].mcs;
+      int channelWidth = points[i].channelWidth;
+      int gi = points[i].gi;
+      double throughput = results[i].throughput;
+      if (i == 0 || mcs != points[i - 1].mcs)
+        {
+          index = 0;
+          previous = 0;
+        }
+      if (results[i].failed)
+        {
+          ReportCheckFailure (points[i], 0, "is missing: the worker failed", failures);
+          index++;
+          continue;
+        }
+      if (!results[i].simulated)
+        {
+          unchecked++;
+          index++;
+          continue;
+        }
+
+      // Confere o primeiro elemento p/ possível erro
+      if (mcs == 0 && channelWidth == 20 && gi == 3200)
+        {
+          if (throughput < minExpectedThroughput)
+            {
+              ReportCheckFailure (points[i], throughput, "is below minExpectedThroughput", failures);
+            }
+        }
+      // Confere o último elemento p/ possível erro
+      if (mcs == 11 && channelWidth == 160 && gi == 800)
+        {
+          if (maxExpectedThroughput > 0 && throughput > maxExpectedThroughput)
+            {
+              ReportCheckFailure (points[i], throughput, "is above maxExpectedThroughput", failures);
+            }
+        }
+      if (!checkMonotonicity)
+        {
+          continue;
+        }
+      // Confere se o valor anterior de vazão era menor para o mesmo MCS
+      if (throughput > previous)
+        {
+          previous = throughput;
+        }
+      else
+        {
+          ReportCheckFailure (points[i], throughput, "does not increase with channel width and GI", failures);
+        }
+      // Confere se o valor anterior de vazão era menor para mesma BW e GI
+      if (throughput > prevThroughput [index])
+        {
+          prevThroughput [index] = throughput;
+        }
+      else
+        {
+          ReportCheckFailure (points[i], throughput, "does not increase with MCS", failures);
+        }
+      index++;
+    }
+  if (unchecked > 0)
+    {
+      std::cerr << unchecked << " of " << points.size () << " point(s) were not simulated and were left out of the checks" << std::endl;
+    }
+  return failures;
+}
 
 // Função principal
 int main (int argc, char *argv[])
@@ -95,7 +2452,33 @@ int main (int argc, char *argv[])
   int mcs = -1; // definição do MCS: -1 para percorrer de 0 a 11 ou 'x', onde a simulação roda para apenas o MCS 'x'
   double minExpectedThroughput = 0; // valores máximo e mínimo para vazão esperada
   double maxExpectedThroughput = 0;
-  
+  uint32_t workers = 0; // processos simultâneos na varredura: 0 para todos os núcleos, 1 para execução sequencial
+  bool reuseTopology = false; // reaproveita nós, pilhas e aplicações entre os pontos da varredura
+  bool estimate = false; // acrescenta à tabela a vazão prevista pelo modelo analítico
+  bool estimateOnly = false; // não simula nenhum ponto, apenas estima
+  double screenMargin = 0; // se > 0, não simula os pontos cuja estimativa fique abaixo de todos os limites por esta margem relativa
+  double screenThroughput = 0; // limite adicional de vazão [Mbit/s] usado na triagem
+  bool checkMonotonicity = true; // verifica que a vazão cresce com o MCS, a largura do canal e o GI
+  bool saturationSource = true; // fonte UDP que reabastece a fila da MAC em vez do UdpClient de 10 us
+  std::string statsFile = ""; // arquivo binário (acrescentado) com os contadores por fluxo de cada ponto
+  std::string convertStats = ""; // converte um arquivo de estatísticas e encerra, sem simular
+  std::string statsFormat = "csv"; // formato da conversão: csv ou xml
+  std::string journal = ""; // diário durável com o resultado de cada ponto concluído
+  bool resume = false; // reaproveita os pontos já registrados no diário com a mesma configuração
+  bool cachePropagation = true; // memoriza a perda e o atraso de propagação de cada par de nós
+  bool indexedChannel = false; // agenda apenas as recepções acima de rxPowerFloor
+  double rxPowerFloor = -110; // piso de potência recebida do canal indexado [dBm]
+  bool profile = false; // imprime o perfil de execução de cada ponto
+  std::string profileFile = ""; // acrescenta o perfil de cada ponto em JSON a este arquivo
+  double convergenceTarget = 0; // erro relativo que encerra cada ponto (0 = duração fixa)
+  double batchTime = 0.1; // duração de cada janela de amostragem da vazão [s]
+  uint32_t minBatches = 10; // quantidade mínima de lotes antes de encerrar um ponto
+  uint32_t nStations = 1; // STAs associadas ao AP: acima de 1, modo denso com fluxos nas duas direções
+  double stationRate = 0; // taxa oferecida por fluxo [Mbit/s]; 0 para saturação
+  std::string stationsFile = ""; // CSV com a vazão de cada estação no modo denso
+  bool latency = true; // mede o atraso e o jitter dos pacotes recebidos
+  bool dual = false; // simula cada combinação com UDP e com TCP e compara as vazões
+
   // Definição dos parâmetros de simulação via linha de comando
   CommandLine cmd;
   cmd.AddValue ("frequency", "Whether working in the 2.4 or 5.0 GHz band (other values gets rejected)", frequency);
@@ -106,21 +2489,95 @@ int main (int argc, char *argv[])
   cmd.AddValue ("mcs", "if set, limit testing to a specific MCS (0-7)", mcs);
   cmd.AddValue ("minExpectedThroughput", "if set, simulation fails if the lowest throughput is below this value", minExpectedThroughput);
   cmd.AddValue ("maxExpectedThroughput", "if set, simulation fails if the highest throughput is above this value", maxExpectedThroughput);
+  cmd.AddValue ("workers", "Number of sweep points simulated concurrently in child processes (0, the default: one per core; 1: sequential)", workers);
+  cmd.AddValue ("reuseTopology", "Build the topology once per process and only reconfigure MCS, channel width and GI between sweep points", reuseTopology);
+  cmd.AddValue ("estimate", "Add the analytic saturation goodput estimate to the table", estimate);
+  cmd.AddValue ("estimateOnly", "Only print the analytic estimates, without simulating any point", estimateOnly);
+  cmd.AddValue ("screenMargin", "if set, skip simulating the points whose analytic throughput upper bound is more than this relative margin below every throughput threshold (requires checkMonotonicity=0)", screenMargin);
+  cmd.AddValue ("screenThroughput", "Additional throughput threshold in Mbit/s used by screenMargin", screenThroughput);
+  cmd.AddValue ("checkMonotonicity", "Fail if the throughput does not increase with MCS, channel width and GI", checkMonotonicity);
+  cmd.AddValue ("saturationSource", "UDP only: keep the MAC queue topped up with a SaturationSource instead of polling with UdpClient every 10 us", saturationSource);
+  cmd.AddValue ("statsFile", "if set, append the per-flow FlowMonitor counters of every sweep point to this binary file", statsFile);
+  cmd.AddValue ("convertStats", "Convert the given binary stats file to text on standard output and exit", convertStats);
+  cmd.AddValue ("statsFormat", "Output format used by convertStats: csv or xml", statsFormat);
+  cmd.AddValue ("journal", "if set, durably record every completed sweep point in this file", journal);
+  cmd.AddValue ("resume", "Skip the points already recorded in the journal under an identical configuration", resume);
+  cmd.AddValue ("cachePropagation", "Compute the propagation loss and delay of each node pair once and reuse them until a node moves", cachePropagation);
+  cmd.AddValue ("indexedChannel", "Use a spatially indexed channel that only schedules receptions at or above rxPowerFloor", indexedChannel);
+  cmd.AddValue ("rxPowerFloor", "Lowest received power (dBm) scheduled by the indexed channel", rxPowerFloor);
+  cmd.AddValue ("profile", "Print the wall time per phase, event counts and process peak RSS after every sweep point to standard error", profile);
+  cmd.AddValue ("profileFile", "if set, append the profile of every sweep point to this file, one JSON object per line", profileFile);
+  cmd.AddValue ("convergenceTarget", "if set, end each point once the goodput is steady and its 95% confidence half-width is below this fraction of the mean; simulationTime becomes the cap", convergenceTarget);
+  cmd.AddValue ("batchTime", "Goodput sampling window used by convergenceTarget (s)", batchTime);
+  cmd.AddValue ("minBatches", "Minimum number of batches before a point may end on convergenceTarget", minBatches);
+  cmd.AddValue ("nStations", "Number of STAs; above 1, dense-BSS mode with one downlink and one uplink flow per STA, placed on a circle of radius distance", nStations);
+  cmd.AddValue ("stationRate", "Offered load of each flow in Mbit/s (0: saturated)", stationRate);
+  cmd.AddValue ("stationsFile", "Dense-BSS mode: if set, write the downlink and uplink goodput of every station to this CSV file", stationsFile);
+  cmd.AddValue ("latency", "Measure the 50th/99th/99.9th percentiles of the one-way delay and jitter of the received packets", latency);
+  cmd.AddValue ("dual", "Simulate every point with both UDP and TCP in parallel workers (udp is ignored) and print both goodputs and their ratio", dual);
   cmd.Parse (argc,argv);
 
-  // Configuração do mecanismo de redução de colisão: RTS
-  if (useRts)
+  if (!convertStats.empty ())
     {
-      Config::SetDefault ("ns3::WifiRemoteStationManager::RtsCtsThreshold", StringValue ("0"));
+      ConvertStatsFile (convertStats, statsFormat, std::cout);
+      return 0;
     }
 
-  // Configuração para percorrer os valores de MCS com base nos valores já calculados
-  double prevThroughput [12];
-  for (uint32_t l = 0; l < 12; l++)
+  if (frequency != 5.0 && frequency != 2.4)
     {
-      prevThroughput[l] = 0;
+      std::cout << "Wrong frequency value!" << std::endl;
+      return 0;
+    }
+  if (workers == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      workers = cores > 0 ? cores : 1;
     }
-  std::cout << "MCS value" << "\t\t" << "Channel width" << "\t\t" << "GI" << "\t\t\t" << "Throughput" << '\n';
+  if (dual)
+    {
+      // As duas variantes de cada combinação rodam em processos separados
+      udp = true;
+      workers = std::max<uint32_t> (workers, 2);
+    }
+  if (convergenceTarget > 0 && (batchTime <= 0 || minBatches < 2))
+    {
+      std::cout << "batchTime must be positive and minBatches at least 2" << std::endl;
+      return 1;
+    }
+  if (nStations == 0 || nStations > 65000 || stationRate < 0)
+    {
+      std::cout << "nStations must be between 1 and 65000 and stationRate non-negative" << std::endl;
+      return 1;
+    }
+
+  SweepConfig config;
+  config.udp = udp;
+  config.simulationTime = simulationTime;
+  config.distance = distance;
+  config.frequency = frequency;
+  config.useRts = useRts;
+  config.reuseTopology = reuseTopology;
+  config.saturationSource = saturationSource;
+  config.flowStats = !statsFile.empty ();
+  config.cachePropagation = cachePropagation;
+  config.indexedChannel = indexedChannel;
+  config.rxPowerFloor = rxPowerFloor;
+  config.profile = profile;
+  config.profileFile = profileFile;
+  config.convergenceTarget = convergenceTarget;
+  config.batchTime = batchTime;
+  config.minBatches = minBatches;
+  config.nStations = nStations;
+  config.stationRate = stationRate;
+  config.latency = latency;
+  config.dual = dual;
+  if (profile || !profileFile.empty ())
+    {
+      RunProfiler::Enable ();
+    }
+
+  // Monta a lista de pontos na mesma ordem da tabela: MCS, largura do canal e GI.
+  // Cada ponto usa o seu próprio número de execução a partir de RngRun.
   int minMcs = 0;
   int maxMcs = 11;
   if (mcs >= 0 && mcs <= 11)
@@ -128,217 +2585,194 @@ int main (int argc, char *argv[])
       minMcs = mcs;
       maxMcs = mcs;
     }
+  uint32_t baseRun = RngSeedManager::GetRun ();
+  std::vector<SweepPoint> points;
   for (int mcs = minMcs; mcs <= maxMcs; mcs++) // Seleção do MCS
     {
-      uint8_t index = 0;
-      double previous = 0;
       uint8_t maxChannelWidth = frequency == 2.4 ? 40 : 160;
       for (int channelWidth = 20; channelWidth <= maxChannelWidth; ) // Seleção da largura de banda [MHz]
         {
           for (int gi = 3200; gi >= 800; ) // Seleção do Intervalo de Guarda [ns]
             {
-              uint32_t payloadSize; // tamanho do pacote: 1500 bytes
-              if (udp)
-                {
-                  payloadSize = 1472; // bytes
-                }
-              else
-                {
-                  payloadSize = 1448; // bytes
-                  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (payloadSize));
-                }
-              
-              // Define os nós STA e AP
-              NodeContainer wifiStaNode;
-              wifiStaNode.Create (1);
-              NodeContainer wifiApNode;
-              wifiApNode.Create (1);
-
-              // Criação do canal
-              YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
-              YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
-              phy.SetChannel (channel.Create ());
-
-              // Define o intervalo de guarda
-              phy.Set ("GuardInterval", TimeValue (NanoSeconds (gi)));
-
-              // Configuração da MAC layer
-              WifiMacHelper mac;
-              WifiHelper wifi;
-              if (frequency == 5.0)
-                {
-                  wifi.SetStandard (WIFI_PHY_STANDARD_80211ax_5GHZ);
-                }
-              else if (frequency == 2.4)
+              SweepPoint point;
+              point.mcs = mcs;
+              point.channelWidth = channelWidth;
+              point.gi = gi;
+              point.run = baseRun + (dual ? points.size () / 2 : points.size ());
+              point.udp = udp;
+              points.push_back (point);
+              if (dual)
                 {
-                  wifi.SetStandard (WIFI_PHY_STANDARD_80211ax_2_4GHZ);
-                  Config::SetDefault ("ns3::LogDistancePropagationLossModel::ReferenceLoss", DoubleValue (40.046));
+                  // Variante TCP logo após a UDP, com o mesmo RngRun
+                  point.udp = false;
+                  points.push_back (point);
                 }
-              else
-                {
-                  std::cout << "Wrong frequency value!" << std::endl;
-                  return 0;
-                }
-
-              // Configuração dos dispositivos
-              std::ostringstream oss;
-              oss << "HeMcs" << mcs;
-              wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager","DataMode", StringValue (oss.str ()),
-                                            "ControlMode", StringValue (oss.str ()));
-
-              Ssid ssid = Ssid ("ns3-80211ax");
-
-              mac.SetType ("ns3::StaWifiMac",
-                           "Ssid", SsidValue (ssid));
-
-              NetDeviceContainer staDevice;
-              staDevice = wifi.Install (phy, mac, wifiStaNode);
-
-              mac.SetType ("ns3::ApWifiMac",
-                           "EnableBeaconJitter", BooleanValue (false),
-                           "Ssid", SsidValue (ssid));
-
-              NetDeviceContainer apDevice;
-              apDevice = wifi.Install (phy, mac, wifiApNode);
-
-              // Define a largura do canal
-              Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue (channelWidth));
-
-              // Configuração de mobilidade dos objetos que caracterizam os dispositivos
-              MobilityHelper mobility;
-              Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
-
-              positionAlloc->Add (Vector (0.0, 0.0, 0.0));
-              positionAlloc->Add (Vector (distance, 0.0, 0.0));
-              mobility.SetPositionAllocator (positionAlloc);
-
-              // Modelo em que a posição atual não é alterada quando já foi configurada a não ser que seja reconfigurada
-              mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-              mobility.Install (wifiApNode);
-              mobility.Install (wifiStaNode);
-
+              gi /= 2;
+            }
+          channelWidth *= 2;
+        }
+    }
 
-              // Configura pilha de protocolos IP
-              // A classe InternetStackHelper agrega funcionalidades IP/TCP/UDP aos nós
-              InternetStackHelper stack;
-              stack.Install (wifiApNode);
-              stack.Install (wifiStaNode);
-              Ipv4AddressHelper address;
-              address.SetBase ("192.168.1.0", "255.255.255.0");
-              Ipv4InterfaceContainer staNodeInterface;
-              Ipv4InterfaceContainer apNodeInterface;
-              staNodeInterface = address.Assign (staDevice);
-              apNodeInterface = address.Assign (apDevice);
+  // Limites de vazão usados pela triagem: sem nenhum, nenhum ponto seria simulado
+  std::vector<double> thresholds;
+  if (minExpectedThroughput > 0)
+    {
+      thresholds.push_back (minExpectedThroughput);
+    }
+  if (maxExpectedThroughput > 0)
+    {
+      thresholds.push_back (maxExpectedThroughput);
+    }
+  if (screenThroughput > 0)
+    {
+      thresholds.push_back (screenThroughput);
+    }
+  if (screenMargin > 0 && thresholds.empty ())
+    {
+      std::cout << "screenMargin requires minExpectedThroughput, maxExpectedThroughput or screenThroughput" << std::endl;
+      return 1;
+    }
+  if (screenMargin > 0 && checkMonotonicity)
+    {
+      // Um ponto não simulado não pode ser comparado com os vizinhos
+      std::cout << "screenMargin skips points that the monotonicity checks need; add --checkMonotonicity=0" << std::endl;
+      return 1;
+    }
 
-              // Configuração da aplicação
-              ApplicationContainer serverApp;
-              if (udp)
-                {
-                  // UDP flow
-                  uint16_t port = 9;
-                  UdpServerHelper server (port);
-                  serverApp = server.Install (wifiStaNode.Get (0));
-                  serverApp.Start (Seconds (0.0));
-                  serverApp.Stop (Seconds (simulationTime + 1));
-
-                  UdpClientHelper client (staNodeInterface.GetAddress (0), port);
-                  client.SetAttribute ("MaxPackets", UintegerValue (4294967295u));
-                  client.SetAttribute ("Interval", TimeValue (Time ("0.00001"))); //packets/s
-                  client.SetAttribute ("PacketSize", UintegerValue (payloadSize));
-                  ApplicationContainer clientApp = client.Install (wifiApNode.Get (0));
-                  clientApp.Start (Seconds (1.0));
-                  clientApp.Stop (Seconds (simulationTime + 1));
-                }
-              else
-                {
-                  // TCP flow
-                  uint16_t port = 50000;
-                  Address localAddress (InetSocketAddress (Ipv4Address::GetAny (), port));
-                  PacketSinkHelper packetSinkHelper ("ns3::TcpSocketFactory", localAddress);
-                  serverApp = packetSinkHelper.Install (wifiStaNode.Get (0));
-                  serverApp.Start (Seconds (0.0));
-                  serverApp.Stop (Seconds (simulationTime + 1));
-
-                  OnOffHelper onoff ("ns3::TcpSocketFactory", Ipv4Address::GetAny ());
-                  onoff.SetAttribute ("OnTime",  StringValue ("ns3::ConstantRandomVariable[Constant=1]"));
-                  onoff.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0]"));
-                  onoff.SetAttribute ("PacketSize", UintegerValue (payloadSize));
-                  onoff.SetAttribute ("DataRate", DataRateValue (1000000000)); //bit/s
-                  AddressValue remoteAddress (InetSocketAddress (staNodeInterface.GetAddress (0), port));
-                  onoff.SetAttribute ("Remote", remoteAddress);
-                  ApplicationContainer clientApp = onoff.Install (wifiApNode.Get (0));
-                  clientApp.Start (Seconds (1.0));
-                  clientApp.Stop (Seconds (simulationTime + 1));
-                }
+  SweepJournal *sweepJournal = 0;
+  if (!journal.empty ())
+    {
+      sweepJournal = new SweepJournal (journal, GetConfigHash (config));
+    }
+  else if (resume)
+    {
+      std::cout << "resume requires a journal file" << std::endl;
+      return 1;
+    }
 
-              Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  bool showEstimate = estimate || estimateOnly || screenMargin > 0;
+  std::cout << "MCS value" << "\t\t" << "Channel width" << "\t\t" << "GI" << "\t\t\t";
+  if (dual)
+    {
+      std::cout << "UDP throughput" << "\t\t" << "TCP throughput" << "\t\t" << "TCP/UDP";
+    }
+  else
+    {
+      std::cout << "Throughput";
+    }
+  if (latency && !dual)
+    {
+      std::cout << "\t\t" << "Latency p50/p99/p999" << "\t\t" << "Jitter p50/p99/p999";
+    }
+  if (showEstimate)
+    {
+      std::cout << "\t\t" << "Estimate";
+    }
+  if (nStations > 1 && !dual)
+    {
+      std::cout << "\t\t" << "Down/Up" << "\t\t" << "Jain" << "\t\t" << "Down p50/p99/p999" << "\t\t" << "Up p50/p99/p999";
+    }
+  std::cout << '\n';
 
-              // Configura a utilização do monitoramento com Flow Monitor
-              Ptr<FlowMonitor> flowMonitor;
-              FlowMonitorHelper flowHelper;
-              flowMonitor = flowHelper.InstallAll();
-              Simulator::Stop (Seconds (simulationTime + 1));
-              flowMonitor->SerializeToXmlFile("he-wifi-network.xml", true, true);
-              Simulator::Run ();
+  // Sem estimativa, as linhas são impressas à medida que os pontos terminam; com ela,
+  // a tabela completa é impressa no final
+  SweepReport report (points, !showEstimate, latency, dual, sweepJournal);
 
-              uint64_t rxBytes = 0;
-              if (udp)
-                {
-                  rxBytes = payloadSize * DynamicCast<UdpServer> (serverApp.Get (0))->GetReceived ();
-                }
-              else
-                {
-                  rxBytes = DynamicCast<PacketSink> (serverApp.Get (0))->GetTotalRx ();
-                }
-              double throughput = (rxBytes * 8) / (simulationTime * 1000000.0); //Mbit/s
+  // Pontos já concluídos em uma execução anterior interrompida
+  if (resume)
+    {
+      for (std::size_t i = 0; i < points.size (); i++)
+        {
+          SweepResult result;
+          if (sweepJournal->Find (points[i], result))
+            {
+              report.Complete (i, result, false);
+            }
+        }
+    }
 
-              Simulator::Destroy ();
+  // Triagem: o limite superior analítico da vazão de cada ponto é comparado com os limites
+  // conhecidos, e o ponto só deixa de ser simulado quando fica abaixo de todos eles por
+  // mais de 'screenMargin' (a vazão simulada também ficaria abaixo deles). Os pontos
+  // verificados por minExpectedThroughput e maxExpectedThroughput são sempre simulados.
+  // Os demais são simulados em ordem crescente de distância relativa da estimativa ao
+  // limite mais próximo, para que os casos mais incertos terminem primeiro.
+  std::vector<std::pair<double, std::size_t> > ranking;
+  for (std::size_t i = 0; i < points.size (); i++)
+    {
+      double distanceToThreshold = 0;
+      bool decided = false; // a estimativa prova a posição do ponto em relação a todos os limites
+      if (showEstimate)
+        {
+          SweepConfig pointConfig = GetPointConfig (config, points[i]);
+          double pointEstimate = EstimateThroughput (pointConfig, points[i]);
+          double pointBound = GetThroughputBound (pointConfig, points[i]);
+          report.GetResult (i).estimate = pointEstimate;
+          distanceToThreshold = std::numeric_limits<double>::max ();
+          decided = !thresholds.empty () && !IsCheckedCorner (points[i]);
+          for (std::size_t j = 0; j < thresholds.size (); j++)
+            {
+              distanceToThreshold = std::min (distanceToThreshold, std::abs (thresholds[j] - pointEstimate) / thresholds[j]);
+              decided = decided && (thresholds[j] - pointBound) / thresholds[j] > screenMargin;
+            }
+        }
+      if (report.IsDone (i) || estimateOnly || (screenMargin > 0 && decided))
+        {
+          continue;
+        }
+      ranking.push_back (std::make_pair (distanceToThreshold, i));
+    }
+  std::stable_sort (ranking.begin (), ranking.end ());
+  std::vector<std::size_t> pending;
+  for (std::size_t i = 0; i < ranking.size (); i++)
+    {
+      pending.push_back (ranking[i].second);
+    }
 
-              std::cout << mcs << "\t\t\t" << channelWidth << " MHz\t\t\t" << gi << " ns\t\t\t" << throughput << " Mbit/s" << std::endl;
+  RunSweep (config, points, pending, workers, report);
 
-              // Confere o primeiro elemento p/ possível erro
-              if (mcs == 0 && channelWidth == 20 && gi == 3200)
-                {
-                  if (throughput < minExpectedThroughput)
-                    {
-                      NS_LOG_ERROR ("Obtained throughput " << throughput << " is not expected!");
-                      exit (1);
-                    }
-                }
-              // Confere o último elemento p/ possível erro
-              if (mcs == 11 && channelWidth == 160 && gi == 800)
-                {
-                  if (maxExpectedThroughput > 0 && throughput > maxExpectedThroughput)
-                    {
-                      NS_LOG_ERROR ("Obtained throughput " << throughput << " is not expected!");
-                      exit (1);
-                    }
-                }
-              // Confere se o valor anterior de vazão era menor para o mesmo MCS
-              if (throughput > previous)
-                {
-                  previous = throughput;
-                }
-              else
-                {
-                  NS_LOG_ERROR ("Obtained throughput " << throughput << " is not expected!");
-                  exit (1);
-                }
-              // Confere se o valor anterior de vazão era menor para mesma BW e GI
-              if (throughput > prevThroughput [index])
-                {
-                  prevThroughput [index] = throughput;
-                }
-              else
-                {
-                  NS_LOG_ERROR ("Obtained throughput " << throughput << " is not expected!");
-                  exit (1);
-                }
-              index++;
-              gi /= 2;
+  const std::vector<SweepResult> &results = report.GetResults ();
+  if (showEstimate)
+    {
+      for (std::size_t i = 0; i < points.size (); i += dual ? 2 : 1)
+        {
+          if (dual)
+            {
+              PrintDualRow (points[i], results[i], results[i + 1], true);
             }
-          channelWidth *= 2;
+          else
+            {
+              PrintSweepRow (points[i], results[i], latency, true);
+            }
+        }
+    }
+  if (!statsFile.empty ())
+    {
+      WriteStatsFile (statsFile, report);
+    }
+  if (!stationsFile.empty ())
+    {
+      WriteStationsFile (stationsFile, points, results);
+    }
+  delete sweepJournal;
+
+  // As verificações de monotonicidade valem para cada transporte separadamente
+  uint32_t failures = 0;
+  for (uint32_t variant = 0; variant < (dual ? 2 : 1); variant++)
+    {
+      std::vector<SweepPoint> variantPoints;
+      std::vector<SweepResult> variantResults;
+      for (std::size_t i = variant; i < points.size (); i += dual ? 2 : 1)
+        {
+          variantPoints.push_back (points[i]);
+          variantResults.push_back (results[i]);
         }
+      failures += CheckSweepResults (variantPoints, variantResults, minExpectedThroughput, maxExpectedThroughput, checkMonotonicity);
+    }
+  if (failures > 0)
+    {
+      std::cerr << failures << " check(s) failed" << std::endl;
+      return 1;
     }
   return 0;
 }
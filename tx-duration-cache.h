@@ -0,0 +1,238 @@
+/*
+## RESUMO ##
+
+Cache de tempos de transmissão compartilhado por trabalho.cc e power-adaptation-distance.cc.
+
+> TxDurationCache::GetTxDuration: resultado de WifiPhy::CalculateTxDuration guardado
+por (modo, preâmbulo, largura do canal, intervalo de guarda, fluxos espaciais, STBC,
+frequência, tamanho). Cada combinação é calculada uma única vez por processo, na
+primeira consulta.
+> TxDurationCache::GetModeTable: tabela imutável com os modos de uma PHY, a taxa de cada
+modo e o tempo de transmissão de cada tamanho de pacote em cada modo. A tabela é
+construída na primeira consulta e compartilhada, por referência, por todas as PHYs com
+a mesma lista de modos (isto é, o mesmo padrão), largura do canal, intervalo de guarda
+(curto ou não em HT/VHT e o valor em HE), frequência, preâmbulo e tamanhos de pacote. Assim, com vários APs ou várias execuções no mesmo
+processo, cada configuração é calculada e guardada uma única vez.
+As tabelas nunca são removidas; as referências valem até o fim do processo.
+*/
+
+#ifndef TX_DURATION_CACHE_H
+#define TX_DURATION_CACHE_H
+
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-tx-vector.h"
+#include "ns3/wifi-utils.h"
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+// Modos de uma PHY e tempos de transmissão de cada tamanho de pacote em cada modo
+struct ModeTable
+{
+  std::vector<WifiMode> modes;
+  std::vector<uint64_t> dataRates; // taxa de cada modo na largura do canal e no intervalo de guarda [bit/s]
+  std::unordered_map<uint64_t, uint32_t> modeIndex; // taxa (bit/s) -> índice do modo
+  std::vector<uint32_t> packetSizes; // tamanhos de pacote presentes na tabela
+  std::vector<double> txTimes; // [sizeIndex * modes.size () + mode] -> tempo de transmissão (s)
+};
+
+class TxDurationCache
+{
+public:
+  static Time GetTxDuration (uint32_t size, const WifiTxVector &txVector, uint16_t frequency);
+  static const ModeTable &GetModeTable (Ptr<WifiPhy> phy, WifiPreamble preamble, const std::vector<uint32_t> &packetSizes);
+
+private:
+  struct DurationKey
+  {
+    uint32_t mode; // WifiMode::GetUid
+    uint32_t preamble;
+    uint16_t channelWidth; // [MHz]
+    uint16_t guardInterval; // [ns]
+    uint8_t nss;
+    uint8_t ness;
+    bool stbc;
+    uint16_t frequency; // [MHz]
+    uint32_t size; // [bytes]
+    bool operator< (const DurationKey &other) const;
+  };
+
+  struct TableKey
+  {
+    std::vector<uint32_t> modes; // WifiMode::GetUid de cada modo, na ordem da PHY
+    uint16_t channelWidth; // [MHz]
+    bool shortGuardInterval; // HT/VHT
+    uint16_t guardInterval; // HE [ns]
+    uint16_t frequency; // [MHz]
+    uint32_t preamble;
+    std::vector<uint32_t> packetSizes;
+    bool operator< (const TableKey &other) const;
+  };
+
+  static std::map<DurationKey, Time> &GetDurations (void);
+  static std::map<TableKey, ModeTable> &GetTables (void);
+};
+
+inline bool
+TxDurationCache::DurationKey::operator< (const DurationKey &other) const
+{
+  if (mode != other.mode)
+    {
+      return mode < other.mode;
+    }
+  if (preamble != other.preamble)
+    {
+      return preamble < other.preamble;
+    }
+  if (channelWidth != other.channelWidth)
+    {
+      return channelWidth < other.channelWidth;
+    }
+  if (guardInterval != other.guardInterval)
+    {
+      return guardInterval < other.guardInterval;
+    }
+  if (nss != other.nss)
+    {
+      return nss < other.nss;
+    }
+  if (ness != other.ness)
+    {
+      return ness < other.ness;
+    }
+  if (stbc != other.stbc)
+    {
+      return stbc < other.stbc;
+    }
+  if (frequency != other.frequency)
+    {
+      return frequency < other.frequency;
+    }
+  return size < other.size;
+}
+
+inline bool
+TxDurationCache::TableKey::operator< (const TableKey &other) const
+{
+  if (channelWidth != other.channelWidth)
+    {
+      return channelWidth < other.channelWidth;
+    }
+  if (shortGuardInterval != other.shortGuardInterval)
+    {
+      return shortGuardInterval < other.shortGuardInterval;
+    }
+  if (guardInterval != other.guardInterval)
+    {
+      return guardInterval < other.guardInterval;
+    }
+  if (frequency != other.frequency)
+    {
+      return frequency < other.frequency;
+    }
+  if (preamble != other.preamble)
+    {
+      return preamble < other.preamble;
+    }
+  if (modes != other.modes)
+    {
+      return modes < other.modes;
+    }
+  return packetSizes < other.packetSizes;
+}
+
+inline std::map<TxDurationCache::DurationKey, Time> &
+TxDurationCache::GetDurations (void)
+{
+  static std::map<DurationKey, Time> durations;
+  return durations;
+}
+
+inline std::map<TxDurationCache::TableKey, ModeTable> &
+TxDurationCache::GetTables (void)
+{
+  static std::map<TableKey, ModeTable> tables;
+  return tables;
+}
+
+// Duração de um quadro de 'size' bytes (MPDU normal), calculada uma única vez por combinação
+inline Time
+TxDurationCache::GetTxDuration (uint32_t size, const WifiTxVector &txVector, uint16_t frequency)
+{
+  DurationKey key;
+  key.mode = txVector.GetMode ().GetUid ();
+  key.preamble = txVector.GetPreambleType ();
+  key.channelWidth = txVector.GetChannelWidth ();
+  key.guardInterval = txVector.GetGuardInterval ();
+  key.nss = txVector.GetNss ();
+  key.ness = txVector.GetNess ();
+  key.stbc = txVector.IsStbc ();
+  key.frequency = frequency;
+  key.size = size;
+  std::map<DurationKey, Time> &durations = GetDurations ();
+  std::map<DurationKey, Time>::const_iterator i = durations.find (key);
+  if (i != durations.end ())
+    {
+      return i->second;
+    }
+  Time duration = WifiPhy::CalculateTxDuration (size, txVector, frequency);
+  durations[key] = duration;
+  return duration;
+}
+
+// Tabela de modos e tempos de transmissão da configuração atual de 'phy'
+inline const ModeTable &
+TxDurationCache::GetModeTable (Ptr<WifiPhy> phy, WifiPreamble preamble, const std::vector<uint32_t> &packetSizes)
+{
+  TableKey key;
+  uint32_t nModes = phy->GetNModes ();
+  for (uint32_t i = 0; i < nModes; i++)
+    {
+      key.modes.push_back (phy->GetMode (i).GetUid ());
+    }
+  key.channelWidth = phy->GetChannelWidth ();
+  key.shortGuardInterval = phy->GetShortGuardInterval ();
+  key.guardInterval = phy->GetGuardInterval ().GetNanoSeconds ();
+  key.frequency = phy->GetFrequency ();
+  key.preamble = preamble;
+  key.packetSizes = packetSizes;
+  std::map<TableKey, ModeTable> &tables = GetTables ();
+  std::map<TableKey, ModeTable>::iterator found = tables.find (key);
+  if (found != tables.end ())
+    {
+      return found->second;
+    }
+
+  ModeTable &table = tables[key];
+  table.packetSizes = packetSizes;
+  table.txTimes.resize (packetSizes.size () * nModes);
+  for (uint32_t i = 0; i < nModes; i++)
+    {
+      WifiMode mode = phy->GetMode (i);
+      // Intervalo de guarda do modo: 800 ns nos modos legados, o da PHY nos demais
+      uint16_t guardInterval = ConvertGuardIntervalToNanoSeconds (mode, key.shortGuardInterval, NanoSeconds (key.guardInterval));
+      WifiTxVector txVector;
+      txVector.SetMode (mode);
+      txVector.SetPreambleType (preamble);
+      txVector.SetChannelWidth (key.channelWidth);
+      txVector.SetGuardInterval (guardInterval);
+      txVector.SetNss (1);
+      uint64_t dataRate = mode.GetDataRate (key.channelWidth, guardInterval, 1);
+      table.modes.push_back (mode);
+      table.dataRates.push_back (dataRate);
+      table.modeIndex[dataRate] = i;
+      for (uint32_t j = 0; j < packetSizes.size (); j++)
+        {
+          table.txTimes[j * nModes + i] = GetTxDuration (packetSizes[j], txVector, key.frequency).GetSeconds ();
+        }
+    }
+  return table;
+}
+
+} // namespace ns3
+
+#endif /* TX_DURATION_CACHE_H */
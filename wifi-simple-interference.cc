@@ -15,6 +15,25 @@
 //
 // ./waf --run "wifi-simple-interference --Irss=-90 --delta=3.2"
 //
+// Received packets are only counted; the per-packet "Received one packet"
+// lines of the original example can be obtained with --traceFile=<file>
+// followed by --printTrace=<file>.
+//
+// Frames sent and received by the nodes in pcapNodes (the receiver by
+// default) are captured (Radiotap) into <pcapPrefix>-<RngRun>-<node>-<index>.pcap
+// by one background writer per node; see the pcap* options for port
+// filtering, file rotation and disabling the capture.
+//
+// Sweep mode: any of PrssRange, IrssRange, deltaRange, PpacketSizeRange and
+// IpacketSizeRange ("min:max:step" or "v1,v2,...") turns the run into a grid
+// sweep over the same 3-node topology.  Each grid point is repeated
+// 'trials' times, every trial in its own slot of 'slotTime' seconds, and the
+// capture probability / PER of the primary packet per grid point is written
+// to 'sweepFile'. The receive counters and --traceFile cover every packet
+// received during the sweep, as in a single run:
+//
+// ./waf --run "wifi-simple-interference --IrssRange=-100:-60:1 --deltaRange=-400:400:100 --trials=20"
+//
 
 /*
 ## CLASSES ##
@@ -29,6 +48,13 @@
 #9  - yans-wifi-channel: utilizada para trabalhar o canal que conecta os objetos da Yans-Wifi
 #10 - mobility-model: trabalha informações de posição e velocidade de um objeto
 #11 - internet-stack-helper: agrega as funcionalidades da pilha de protocolos IP/TCP/UDP
+#12 - wifi-net-device: acesso à PHY de cada nó para alterar o ganho entre as tentativas da varredura
+#13 - fstream: arquivo com o resultado da varredura
+#14 - atomic/thread/cstdio: contadores de recepção e anel de eventos esvaziado em uma thread
+#15 - condition_variable/mutex/deque: blocos da captura pcap gravados em uma thread
+#16 - rng-seed-manager/headers: nome da captura por execução e filtro por porta UDP
+#17 - propagation-cache: cache da perda e do atraso de propagação entre os nós
+#18 - profiler: tempo de parede por fase, eventos executados e pico de memória
 
 */
 
@@ -43,56 +69,740 @@
 #include "ns3/yans-wifi-channel.h"
 #include "ns3/mobility-model.h"
 #include "ns3/internet-stack-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "propagation-cache.h"
+#include "profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 using namespace ns3;
 
 // Definição do componente de log: WifiSimpleInterference
 NS_LOG_COMPONENT_DEFINE ("WifiSimpleInterference");
 
-// Função utilizada para retornar as informações do(s) pacote(s) recebido(s): socket e porta
-static inline std::string PrintReceivedPacket (Ptr<Socket> socket)
+// Evento de recepção gravado no arquivo de rastreamento (formato binário fixo)
+struct RxEvent
+{
+  int64_t time; // instante da recepção [ns]
+  uint32_t node; // nó receptor
+  uint32_t size; // tamanho do pacote [bytes]
+  uint16_t port; // porta do socket receptor
+  uint16_t reserved[3];
+};
+
+static const char g_rxTraceMagic[8] = { 'R', 'X', 'T', 'R', 'A', 'C', 'E', '1' };
+
+// Anel de eventos de tamanho fixo, com um produtor (a simulação) e um consumidor (uma
+// thread que grava os eventos no arquivo em blocos). Não há travas: o produtor só
+// avança 'm_head' e o consumidor só avança 'm_tail'. Com o anel cheio o produtor
+// aguarda o consumidor, de modo que nenhum evento é perdido.
+class RxTraceRing
 {
-  Address addr;
+public:
+  RxTraceRing (const std::string &fileName, uint32_t capacity);
+  ~RxTraceRing ();
+
+  void Push (const RxEvent &event);
+  void Stop (void);
+  uint64_t GetStalls (void) const;
+
+private:
+  void Drain (void);
+
+  std::vector<RxEvent> m_events;
+  uint64_t m_mask;
+  std::atomic<uint64_t> m_head; // próximo evento a ser escrito pelo produtor
+  std::atomic<uint64_t> m_tail; // próximo evento a ser gravado pelo consumidor
+  std::atomic<bool> m_stop;
+  uint64_t m_stalls; // vezes em que o produtor encontrou o anel cheio
+  std::FILE *m_file;
+  std::thread m_thread;
+};
+
+RxTraceRing::RxTraceRing (const std::string &fileName, uint32_t capacity)
+  : m_head (0),
+    m_tail (0),
+    m_stop (false),
+    m_stalls (0)
+{
+  uint64_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_events.resize (size);
+  m_mask = size - 1;
+  m_file = std::fopen (fileName.c_str (), "wb");
+  if (m_file == 0)
+    {
+      NS_FATAL_ERROR ("Cannot open trace file " << fileName);
+    }
+  std::fwrite (g_rxTraceMagic, sizeof (g_rxTraceMagic), 1, m_file);
+  m_thread = std::thread (&RxTraceRing::Drain, this);
+}
 
-  std::ostringstream oss;
+RxTraceRing::~RxTraceRing ()
+{
+  Stop ();
+}
 
-  while (socket->Recv ())
+void
+RxTraceRing::Push (const RxEvent &event)
+{
+  uint64_t head = m_head.load (std::memory_order_relaxed);
+  if (head - m_tail.load (std::memory_order_acquire) > m_mask)
     {
-      socket->GetSockName (addr);
-      InetSocketAddress iaddr = InetSocketAddress::ConvertFrom (addr);
+      m_stalls++;
+      while (head - m_tail.load (std::memory_order_acquire) > m_mask)
+        {
+          std::this_thread::yield ();
+        }
+    }
+  m_events[head & m_mask] = event;
+  m_head.store (head + 1, std::memory_order_release);
+}
 
-      oss << "Received one packet!  Socket: " << iaddr.GetIpv4 () << " port: " << iaddr.GetPort ();
+// Encerra a thread após gravar os eventos pendentes
+void
+RxTraceRing::Stop (void)
+{
+  if (m_file == 0)
+    {
+      return;
     }
-// Retorna as informações pertinentes 
-  return oss.str ();
+  m_stop.store (true, std::memory_order_release);
+  m_thread.join ();
+  std::fclose (m_file);
+  m_file = 0;
 }
 
-// Função para printar a mensagem de saída incondicionalmente com NS_LOG_UNCOND
-static void ReceivePacket (Ptr<Socket> socket)
+uint64_t
+RxTraceRing::GetStalls (void) const
 {
-  NS_LOG_UNCOND (PrintReceivedPacket (socket));
+  return m_stalls;
 }
 
-/* Função para gerar o tráfego com base nas informações ligadas ao(s) pacote(s):
-   # socket utilizado
+void
+RxTraceRing::Drain (void)
+{
+  while (true)
+    {
+      // 'm_stop' é lido antes de 'm_head': se estava ativo, nenhum evento novo virá
+      bool stop = m_stop.load (std::memory_order_acquire);
+      uint64_t tail = m_tail.load (std::memory_order_relaxed);
+      uint64_t head = m_head.load (std::memory_order_acquire);
+      if (head == tail)
+        {
+          if (stop)
+            {
+              break;
+            }
+          std::this_thread::sleep_for (std::chrono::milliseconds (1));
+          continue;
+        }
+      // Grava até o fim do anel; o restante fica para a próxima volta
+      uint64_t begin = tail & m_mask;
+      uint64_t count = std::min (head - tail, m_mask + 1 - begin);
+      if (std::fwrite (&m_events[begin], sizeof (RxEvent), count, m_file) != count)
+        {
+          NS_FATAL_ERROR ("Cannot write trace file");
+        }
+      m_tail.store (tail + count, std::memory_order_release);
+    }
+  std::fflush (m_file);
+}
+
+// Contadores de recepção de um socket. Endereço, porta e nó são guardados na criação,
+// para que a recepção não precise consultar o socket.
+struct RxSocketCounters
+{
+  uint32_t node;
+  Ipv4Address address;
+  uint16_t port;
+  std::atomic<uint64_t> packets;
+  std::atomic<uint64_t> bytes;
+};
+
+// Atualiza os contadores do socket com um pacote recebido e, se houver, registra um
+// evento no anel de rastreamento
+static void RecordReception (RxSocketCounters *counters, RxTraceRing *ring, Ptr<const Packet> packet)
+{
+  counters->packets.fetch_add (1, std::memory_order_relaxed);
+  counters->bytes.fetch_add (packet->GetSize (), std::memory_order_relaxed);
+  if (ring != 0)
+    {
+      RxEvent event;
+      std::memset (&event, 0, sizeof (event));
+      event.time = Simulator::Now ().GetNanoSeconds ();
+      event.node = counters->node;
+      event.size = packet->GetSize ();
+      event.port = counters->port;
+      ring->Push (event);
+    }
+}
+
+// Recepção de pacotes
+static void ReceivePacket (RxSocketCounters *counters, RxTraceRing *ring, Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      RecordReception (counters, ring, packet);
+    }
+}
+
+// Captura pcap (Radiotap) gravada por uma thread. Os quadros são copiados para blocos
+// de memória de tamanho fixo; cada bloco cheio é entregue à thread, que o grava de uma
+// vez. Os blocos são reaproveitados, e a simulação só espera se todos estiverem
+// aguardando gravação. Cada arquivo tem no máximo 'maxFileSize' bytes (0 = sem
+// limite); ao atingi-lo a captura continua no próximo arquivo, e com 'maxFiles' > 0 o
+// arquivo mais antigo é apagado, limitando o total em disco.
+class PcapRingWriter
+{
+public:
+  PcapRingWriter (const std::string &prefix, uint32_t blockSize, uint32_t nBlocks,
+                  uint64_t maxFileSize, uint32_t maxFiles);
+  ~PcapRingWriter ();
+
+  void Write (Time time, const uint8_t *radiotap, uint32_t radiotapSize, Ptr<const Packet> packet);
+  void Stop (void);
+
+private:
+  struct Block
+  {
+    std::vector<uint8_t> data;
+    uint32_t used;
+  };
+
+  void Submit (void);
+  void Run (void);
+  void OpenFile (void);
+
+  std::string m_prefix;
+  uint64_t m_maxFileSize;
+  uint32_t m_maxFiles;
+  std::vector<Block> m_blocks;
+  int32_t m_current; // bloco sendo preenchido pela simulação (-1 se nenhum)
+  std::deque<uint32_t> m_free; // blocos disponíveis
+  std::deque<uint32_t> m_full; // blocos aguardando gravação
+  bool m_stop;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::thread m_thread;
+  // Estado da thread de gravação
+  std::FILE *m_file;
+  uint32_t m_fileIndex;
+  uint64_t m_fileSize;
+};
+
+PcapRingWriter::PcapRingWriter (const std::string &prefix, uint32_t blockSize, uint32_t nBlocks,
+                                uint64_t maxFileSize, uint32_t maxFiles)
+  : m_prefix (prefix),
+    m_maxFileSize (maxFileSize),
+    m_maxFiles (maxFiles),
+    m_blocks (std::max<uint32_t> (nBlocks, 2)),
+    m_current (-1),
+    m_stop (false),
+    m_file (0),
+    m_fileIndex (0),
+    m_fileSize (0)
+{
+  for (uint32_t i = 0; i < m_blocks.size (); i++)
+    {
+      m_blocks[i].data.resize (std::max<uint32_t> (blockSize, 65536 + 16 + 64));
+      m_blocks[i].used = 0;
+      m_free.push_back (i);
+    }
+  m_thread = std::thread (&PcapRingWriter::Run, this);
+}
+
+PcapRingWriter::~PcapRingWriter ()
+{
+  Stop ();
+}
+
+// Copia um quadro (cabeçalho Radiotap seguido do pacote) para o bloco atual
+void
+PcapRingWriter::Write (Time time, const uint8_t *radiotap, uint32_t radiotapSize, Ptr<const Packet> packet)
+{
+  uint32_t captured = radiotapSize + packet->GetSize ();
+  uint32_t needed = 16 + captured;
+  if (m_current >= 0 && m_blocks[m_current].used + needed > m_blocks[m_current].data.size ())
+    {
+      Submit ();
+    }
+  if (m_current < 0)
+    {
+      std::unique_lock<std::mutex> lock (m_mutex);
+      m_condition.wait (lock, [this] { return !m_free.empty (); });
+      m_current = m_free.front ();
+      m_free.pop_front ();
+    }
+  Block &block = m_blocks[m_current];
+  NS_ABORT_MSG_IF (needed > block.data.size (), "Frame larger than a pcap block");
+  int64_t us = time.GetMicroSeconds ();
+  uint32_t header[4] = { static_cast<uint32_t> (us / 1000000), static_cast<uint32_t> (us % 1000000), captured, captured };
+  uint8_t *out = &block.data[block.used];
+  std::memcpy (out, header, sizeof (header));
+  std::memcpy (out + sizeof (header), radiotap, radiotapSize);
+  packet->CopyData (out + sizeof (header) + radiotapSize, packet->GetSize ());
+  block.used += needed;
+}
+
+// Entrega o bloco atual à thread de gravação
+void
+PcapRingWriter::Submit (void)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  m_full.push_back (m_current);
+  m_current = -1;
+  m_condition.notify_all ();
+}
+
+// Grava os blocos pendentes e encerra a thread
+void
+PcapRingWriter::Stop (void)
+{
+  if (!m_thread.joinable ())
+    {
+      return;
+    }
+  if (m_current >= 0)
+    {
+      Submit ();
+    }
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+    m_condition.notify_all ();
+  }
+  m_thread.join ();
+  if (m_file != 0)
+    {
+      std::fclose (m_file);
+      m_file = 0;
+    }
+}
+
+// Abre o próximo arquivo da captura, apagando o mais antigo se o limite de arquivos foi atingido
+void
+PcapRingWriter::OpenFile (void)
+{
+  if (m_file != 0)
+    {
+      std::fclose (m_file);
+    }
+  if (m_maxFiles > 0 && m_fileIndex >= m_maxFiles)
+    {
+      std::ostringstream old;
+      old << m_prefix << "-" << m_fileIndex - m_maxFiles << ".pcap";
+      std::remove (old.str ().c_str ());
+    }
+  std::ostringstream name;
+  name << m_prefix << "-" << m_fileIndex++ << ".pcap";
+  m_file = std::fopen (name.str ().c_str (), "wb");
+  if (m_file == 0)
+    {
+      NS_FATAL_ERROR ("Cannot open pcap file " << name.str ());
+    }
+  // Cabeçalho global: versão 2.4, snaplen 65535, DLT_IEEE802_11_RADIO (127)
+  uint32_t magic = 0xa1b2c3d4;
+  uint16_t version[2] = { 2, 4 };
+  int32_t zone = 0;
+  uint32_t sigfigs = 0, snaplen = 65535, linkType = 127;
+  std::fwrite (&magic, sizeof (magic), 1, m_file);
+  std::fwrite (version, sizeof (version), 1, m_file);
+  std::fwrite (&zone, sizeof (zone), 1, m_file);
+  std::fwrite (&sigfigs, sizeof (sigfigs), 1, m_file);
+  std::fwrite (&snaplen, sizeof (snaplen), 1, m_file);
+  std::fwrite (&linkType, sizeof (linkType), 1, m_file);
+  m_fileSize = 24;
+}
+
+void
+PcapRingWriter::Run (void)
+{
+  while (true)
+    {
+      uint32_t index;
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        m_condition.wait (lock, [this] { return m_stop || !m_full.empty (); });
+        if (m_full.empty ())
+          {
+            break;
+          }
+        index = m_full.front ();
+        m_full.pop_front ();
+      }
+      Block &block = m_blocks[index];
+      // O bloco é dividido entre arquivos nos limites dos registros, de modo que nenhum
+      // arquivo passe de 'maxFileSize' (a não ser por um único registro maior que ele)
+      uint32_t start = 0;
+      while (start < block.used)
+        {
+          if (m_file == 0)
+            {
+              OpenFile ();
+            }
+          uint32_t end = start;
+          while (end < block.used)
+            {
+              uint32_t captured;
+              std::memcpy (&captured, &block.data[end + 8], sizeof (captured));
+              uint32_t size = 16 + captured;
+              if (m_maxFileSize > 0 && m_fileSize + (end - start) + size > m_maxFileSize
+                  && (end > start || m_fileSize > 24))
+                {
+                  break;
+                }
+              end += size;
+            }
+          if (end == start)
+            {
+              // O arquivo atual está cheio
+              OpenFile ();
+              continue;
+            }
+          if (std::fwrite (&block.data[start], 1, end - start, m_file) != end - start)
+            {
+              NS_FATAL_ERROR ("Cannot write pcap file");
+            }
+          m_fileSize += end - start;
+          start = end;
+        }
+      block.used = 0;
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_free.push_back (index);
+        m_condition.notify_all ();
+      }
+    }
+}
+
+// Filtro da captura: porta UDP de destino (0 = todas)
+struct PcapFilter
+{
+  PcapRingWriter *writer;
+  uint16_t port;
+};
+
+// Verifica se o quadro transporta um datagrama UDP para a porta 'port'
+static bool MatchesPort (Ptr<const Packet> packet, uint16_t port)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  WifiMacHeader mac;
+  copy->RemoveHeader (mac);
+  if (!mac.IsData ())
+    {
+      return false;
+    }
+  LlcSnapHeader llc;
+  copy->RemoveHeader (llc);
+  if (llc.GetType () != 0x0800)
+    {
+      return false;
+    }
+  Ipv4Header ip;
+  copy->RemoveHeader (ip);
+  if (ip.GetProtocol () != 17)
+    {
+      return false;
+    }
+  UdpHeader udp;
+  copy->RemoveHeader (udp);
+  return udp.GetDestinationPort () == port;
+}
+
+// Monta um cabeçalho Radiotap mínimo (flags, taxa, canal e, na recepção, sinal e ruído)
+// e entrega o quadro ao gravador do nó
+static void PcapSniff (PcapFilter *filter, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                       WifiTxVector txVector, const SignalNoiseDbm *signalNoise)
+{
+  if (filter->port != 0 && !MatchesPort (packet, filter->port))
+    {
+      return;
+    }
+  uint8_t radiotap[16];
+  std::memset (radiotap, 0, sizeof (radiotap));
+  uint16_t length = signalNoise != 0 ? 16 : 14;
+  uint32_t present = (1 << 1) | (1 << 2) | (1 << 3);
+  if (signalNoise != 0)
+    {
+      present |= (1 << 5) | (1 << 6);
+      radiotap[14] = static_cast<uint8_t> (static_cast<int8_t> (signalNoise->signal));
+      radiotap[15] = static_cast<uint8_t> (static_cast<int8_t> (signalNoise->noise));
+    }
+  std::memcpy (radiotap + 2, &length, sizeof (length));
+  std::memcpy (radiotap + 4, &present, sizeof (present));
+  radiotap[8] = 0x10; // FCS incluído no quadro
+  radiotap[9] = static_cast<uint8_t> (txVector.GetMode ().GetDataRate (txVector.GetChannelWidth ()) / 500000);
+  uint16_t channelFlags = channelFreqMhz < 2500 ? 0x00a0 : 0x0140; // CCK 2.4 GHz ou OFDM 5 GHz
+  std::memcpy (radiotap + 10, &channelFreqMhz, sizeof (channelFreqMhz));
+  std::memcpy (radiotap + 12, &channelFlags, sizeof (channelFlags));
+  filter->writer->Write (Simulator::Now (), radiotap, length, packet);
+}
+
+// Quadro recebido pela PHY monitorada
+static void PcapSniffRx (PcapFilter *filter, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                         WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise)
+{
+  PcapSniff (filter, packet, channelFreqMhz, txVector, &signalNoise);
+}
+
+// Quadro transmitido pela PHY monitorada (os nós 1 e 2 não recebem quadros)
+static void PcapSniffTx (PcapFilter *filter, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                         WifiTxVector txVector, MpduInfo aMpdu)
+{
+  PcapSniff (filter, packet, channelFreqMhz, txVector, 0);
+}
+
+// Grava os blocos pendentes e libera os gravadores pcap
+static void DeletePcapWriters (std::vector<PcapFilter> &filters)
+{
+  for (uint32_t i = 0; i < filters.size (); i++)
+    {
+      delete filters[i].writer;
+    }
+  filters.clear ();
+}
+
+// Visão textual de um arquivo de rastreamento, gerada após a simulação
+static int PrintRxTrace (const std::string &fileName)
+{
+  std::FILE *file = std::fopen (fileName.c_str (), "rb");
+  char magic[sizeof (g_rxTraceMagic)];
+  if (file == 0 || std::fread (magic, sizeof (magic), 1, file) != 1
+      || std::memcmp (magic, g_rxTraceMagic, sizeof (magic)) != 0)
+    {
+      NS_LOG_UNCOND (fileName << " is not a receive trace");
+      if (file != 0)
+        {
+          std::fclose (file);
+        }
+      return 1;
+    }
+  RxEvent event;
+  while (std::fread (&event, sizeof (event), 1, file) == 1)
+    {
+      std::cout << NanoSeconds (event.time).GetSeconds () << "s Received one packet!  Node: " << event.node
+                << " port: " << event.port << " size: " << event.size << "\n";
+    }
+  std::fclose (file);
+  return 0;
+}
+
+/* Fonte de tráfego para o socket informado:
    # tamanho do pacote
-   # flag de ordem dos pacotes
-   # instante de envio
-   Caso haja pacotes para transmissão, são enviados ao socket designado, considerando
-   as informações de instante de envio e tamanho.
+   # quantidade de pacotes
+   # intervalo entre pacotes
+   # rajada: quantidade de pacotes enviados pelo mesmo evento
+   Cada evento envia uma rajada de até 'burst' pacotes e agenda o próximo evento para
+   'burst' intervalos depois, mantendo a taxa média; com burst = 1 o comportamento é o
+   de um pacote por intervalo. Ao fim dos pacotes o socket é fechado.
+   Cada envio aloca um Packet novo, como no exemplo original; a carga útil é uma área
+   de zeros virtual do ns-3 e não ocupa memória.
 */
-static void GenerateTraffic (Ptr<Socket> socket, uint32_t pktSize,
-                             uint32_t pktCount, Time pktInterval )
+class TrafficSource
+{
+public:
+  TrafficSource (Ptr<Socket> socket, uint32_t pktSize,
+                 uint32_t pktCount, Time pktInterval, uint32_t burst);
+
+  void Start (Time start);
+
+private:
+  void SendBurst (void);
+
+  Ptr<Socket> m_socket;
+  uint32_t m_pktSize;
+  uint32_t m_remaining; // pacotes ainda não enviados
+  Time m_burstInterval;
+  uint32_t m_burst;
+};
+
+TrafficSource::TrafficSource (Ptr<Socket> socket, uint32_t pktSize,
+                              uint32_t pktCount, Time pktInterval, uint32_t burst)
+  : m_socket (socket),
+    m_pktSize (pktSize),
+    m_remaining (pktCount),
+    m_burstInterval (NanoSeconds (pktInterval.GetNanoSeconds () * static_cast<double> (std::max<uint32_t> (burst, 1)))),
+    m_burst (std::max<uint32_t> (burst, 1))
+{
+}
+
+// Agenda o primeiro envio no instante absoluto 'start', no contexto do nó do socket.
+// O atraso 'delta' entre a fonte primária e a interferente é a diferença entre os
+// instantes de início das duas fontes.
+void
+TrafficSource::Start (Time start)
 {
-  if (pktCount > 0)
+  Simulator::ScheduleWithContext (m_socket->GetNode ()->GetId (), start - Simulator::Now (),
+                                  &TrafficSource::SendBurst, this);
+}
+
+void
+TrafficSource::SendBurst (void)
+{
+  uint32_t n = std::min (m_remaining, m_burst);
+  for (uint32_t i = 0; i < n; i++)
     {
-      socket->Send (Create<Packet> (pktSize));
-      Simulator::Schedule (pktInterval, &GenerateTraffic,
-                           socket, pktSize,pktCount - 1, pktInterval);
+      m_socket->Send (Create<Packet> (m_pktSize));
+    }
+  m_remaining -= n;
+  if (m_remaining > 0)
+    {
+      Simulator::Schedule (m_burstInterval, &TrafficSource::SendBurst, this);
     }
   else
     {
-      socket->Close ();
+      m_socket->Close ();
+    }
+}
+
+// Ponto da grade de varredura: uma combinação de RSS, atraso e tamanhos de pacote
+struct InterferencePoint
+{
+  double Prss;
+  double Irss;
+  double delta;
+  uint32_t PpacketSize;
+  uint32_t IpacketSize;
+};
+
+// Estado da varredura: cada tentativa ocupa um intervalo ("slot") de 'slotTime'
+// segundos; a tentativa 'k' corresponde ao ponto 'k / trials'
+struct InterferenceSweep
+{
+  std::vector<InterferencePoint> points;
+  uint32_t trials; // tentativas por ponto
+  Time start; // início do primeiro intervalo
+  Time slotTime; // duração de cada intervalo
+  Time sendOffset; // envio do pacote primário em relação ao início do intervalo
+  double offset; // ganho de transmissão somado à RSS desejada
+  Ptr<WifiPhy> primaryPhy;
+  Ptr<WifiPhy> interfererPhy;
+  Ptr<Socket> source;
+  Ptr<Socket> interferer;
+  RxSocketCounters *counters; // contadores do socket receptor, como fora da varredura
+  RxTraceRing *ring; // anel de rastreamento (--traceFile), nulo sem ele
+  std::vector<uint8_t> received; // pacote primário recebido em cada tentativa
+};
+
+// Converte uma faixa "min:max:step" (inclusiva) ou uma lista "v1,v2,..." em valores;
+// uma faixa vazia resulta no valor único 'value'
+static std::vector<double> ParseRange (const std::string &range, double value)
+{
+  std::vector<double> values;
+  if (range.empty ())
+    {
+      values.push_back (value);
+      return values;
+    }
+  if (range.find (':') != std::string::npos)
+    {
+      double min, max, step;
+      char c1, c2;
+      std::istringstream iss (range);
+      if (!(iss >> min >> c1 >> max >> c2 >> step) || c1 != ':' || c2 != ':' || step <= 0 || max < min)
+        {
+          NS_FATAL_ERROR ("Invalid range \"" << range << "\"; expected min:max:step");
+        }
+      uint32_t n = static_cast<uint32_t> ((max - min) / step + 1e-9) + 1;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          values.push_back (min + i * step);
+        }
+      return values;
+    }
+  std::istringstream iss (range);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      std::istringstream itemStream (item);
+      double v;
+      if (!(itemStream >> v))
+        {
+          NS_FATAL_ERROR ("Invalid value \"" << item << "\" in \"" << range << "\"");
+        }
+      values.push_back (v);
+    }
+  return values;
+}
+
+static void SendPacket (Ptr<Socket> socket, uint32_t pktSize)
+{
+  socket->Send (Create<Packet> (pktSize));
+}
+
+// Configura as potências da tentativa 'trial', agenda o envio dos dois pacotes no seu
+// intervalo e agenda a próxima tentativa
+static void StartTrial (InterferenceSweep *sweep, uint32_t trial)
+{
+  const InterferencePoint &point = sweep->points[trial / sweep->trials];
+  sweep->primaryPhy->SetTxGain (sweep->offset + point.Prss);
+  sweep->interfererPhy->SetTxGain (sweep->offset + point.Irss);
+
+  Simulator::ScheduleWithContext (sweep->source->GetNode ()->GetId (),
+                                  sweep->sendOffset, &SendPacket,
+                                  sweep->source, point.PpacketSize);
+  Simulator::ScheduleWithContext (sweep->interferer->GetNode ()->GetId (),
+                                  sweep->sendOffset + MicroSeconds (point.delta), &SendPacket,
+                                  sweep->interferer, point.IpacketSize);
+  if (trial + 1 < sweep->received.size ())
+    {
+      Simulator::Schedule (sweep->slotTime, &StartTrial, sweep, trial + 1);
+    }
+}
+
+// Marca como recebido o pacote primário da tentativa do intervalo atual; os contadores e
+// o anel de rastreamento recebem cada pacote, como em ReceivePacket
+static void ReceiveTrialPacket (InterferenceSweep *sweep, Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      RecordReception (sweep->counters, sweep->ring, packet);
+      int64_t slot = (Simulator::Now () - sweep->start).GetInteger () / sweep->slotTime.GetInteger ();
+      if (slot >= 0 && slot < static_cast<int64_t> (sweep->received.size ()))
+        {
+          sweep->received[slot] = 1;
+        }
+    }
+}
+
+// Grava a probabilidade de captura e a PER do pacote primário em cada ponto da grade
+static void WriteSweepResults (const InterferenceSweep &sweep, const std::string &fileName)
+{
+  std::ofstream os (fileName.c_str ());
+  os << "Prss,Irss,delta,PpacketSize,IpacketSize,trials,received,captureProbability,per\n";
+  for (uint32_t i = 0; i < sweep.points.size (); i++)
+    {
+      const InterferencePoint &point = sweep.points[i];
+      uint32_t received = 0;
+      for (uint32_t t = 0; t < sweep.trials; t++)
+        {
+          received += sweep.received[i * sweep.trials + t];
+        }
+      double capture = static_cast<double> (received) / sweep.trials;
+      os << point.Prss << "," << point.Irss << "," << point.delta << "," << point.PpacketSize
+         << "," << point.IpacketSize << "," << sweep.trials << "," << received
+         << "," << capture << "," << 1 - capture << "\n";
     }
 }
 
@@ -105,11 +815,33 @@ int main (int argc, char *argv[])
   uint32_t PpacketSize = 1000; // Primary Packet Size - tamanho do pacote do tranmissor [bytes]
   uint32_t IpacketSize = 1000; // Interfering Packet Size - tamanho do pacote interferente [bytes]
   bool verbose = false; // Configurar informações detalhadas
+  std::string PrssRange = ""; // Faixas da varredura ("min:max:step" ou "v1,v2,...")
+  std::string IrssRange = "";
+  std::string deltaRange = "";
+  std::string PpacketSizeRange = "";
+  std::string IpacketSizeRange = "";
+  uint32_t trials = 1; // Tentativas por ponto da varredura
+  double slotTime = 0.05; // Duração do intervalo de cada tentativa [s]
+  std::string sweepFile = "wifi-simple-interference-sweep.csv"; // Resultado da varredura
+  std::string traceFile = ""; // Arquivo binário com um evento por pacote recebido
+  uint32_t traceRingSize = 65536; // Capacidade do anel de eventos
+  std::string printTrace = ""; // Imprime um arquivo de rastreamento como texto e termina
+  bool pcap = true; // Captura pcap dos quadros transmitidos e recebidos
+  std::string pcapPrefix = "wifi-simple-interference"; // Prefixo dos arquivos pcap
+  std::string pcapNodes = "0"; // Nós capturados ("0,1,2")
+  uint32_t pcapPort = 0; // Porta UDP capturada (0 = todos os quadros)
+  uint32_t pcapBlockSize = 1 << 20; // Tamanho de cada bloco em memória [bytes]
+  uint32_t pcapBlocks = 8; // Quantidade de blocos em memória
+  double pcapMaxFileSize = 0; // Tamanho máximo de cada arquivo [MB] (0 = sem limite)
+  uint32_t pcapMaxFiles = 0; // Arquivos mantidos em rotação (0 = todos)
+  bool cachePropagation = true; // Memoriza a perda e o atraso de propagação entre os nós
+  bool profile = false; // Imprime o perfil de execução
+  std::string profileFile = ""; // Acrescenta o perfil de execução em JSON a este arquivo
 
-  // these are not command line arguments for this version
   uint32_t numPackets = 1; // Número de pacotes enviados
   double interval = 1.0; // Intervalo de envio [s]
   double startTime = 10.0; // Início do tráfego/envio de pacote(s) [s]
+  uint32_t burst = 1; // Pacotes enviados por evento
   double distanceToRx = 300.0; // Distância para o receptor [m]
 
   // This is a magic number used to set the transmit power, based on other configuration
@@ -124,7 +856,52 @@ int main (int argc, char *argv[])
   cmd.AddValue ("PpacketSize", "size of application packet sent", PpacketSize); // Primary Packet Size
   cmd.AddValue ("IpacketSize", "size of interfering packet sent", IpacketSize); // Interfering Packet Size
   cmd.AddValue ("verbose", "turn on all WifiNetDevice log components", verbose); // Detalhamento
+  cmd.AddValue ("PrssRange", "Sweep range of Prss (min:max:step or v1,v2,...)", PrssRange);
+  cmd.AddValue ("IrssRange", "Sweep range of Irss (min:max:step or v1,v2,...)", IrssRange);
+  cmd.AddValue ("deltaRange", "Sweep range of delta (min:max:step or v1,v2,...)", deltaRange);
+  cmd.AddValue ("PpacketSizeRange", "Sweep range of PpacketSize (min:max:step or v1,v2,...)", PpacketSizeRange);
+  cmd.AddValue ("IpacketSizeRange", "Sweep range of IpacketSize (min:max:step or v1,v2,...)", IpacketSizeRange);
+  cmd.AddValue ("trials", "Number of trials per sweep point", trials);
+  cmd.AddValue ("slotTime", "Duration of the time slot of each sweep trial (seconds)", slotTime);
+  cmd.AddValue ("sweepFile", "Output file with the capture probability and PER of each sweep point", sweepFile);
+  cmd.AddValue ("numPackets", "number of packets sent by each source", numPackets);
+  cmd.AddValue ("interval", "interval between packets (seconds)", interval);
+  cmd.AddValue ("startTime", "time of the first primary packet (seconds)", startTime);
+  cmd.AddValue ("burst", "number of packets sent back-to-back by each scheduled event", burst);
+  cmd.AddValue ("traceFile", "Binary file receiving one record per received packet (written by a background thread)", traceFile);
+  cmd.AddValue ("traceRingSize", "Number of receive events buffered in memory before the writer thread catches up", traceRingSize);
+  cmd.AddValue ("printTrace", "Print a receive trace file as text and exit", printTrace);
+  cmd.AddValue ("pcap", "Capture the frames sent and received by pcapNodes, one set of files per node", pcap);
+  cmd.AddValue ("pcapPrefix", "Prefix of the pcap files, followed by the run number, the node and the file index", pcapPrefix);
+  cmd.AddValue ("pcapNodes", "Comma-separated list of captured nodes (0 = receiver, 1 = transmitter, 2 = interferer)", pcapNodes);
+  cmd.AddValue ("pcapPort", "Only capture UDP datagrams to this port (0 = all frames)", pcapPort);
+  cmd.AddValue ("pcapBlockSize", "Size of each in-memory pcap block (bytes)", pcapBlockSize);
+  cmd.AddValue ("pcapBlocks", "Number of in-memory pcap blocks", pcapBlocks);
+  cmd.AddValue ("pcapMaxFileSize", "Start a new pcap file once this size is reached (MB, 0 = unlimited)", pcapMaxFileSize);
+  cmd.AddValue ("pcapMaxFiles", "Keep only the most recent pcap files (0 = keep all)", pcapMaxFiles);
+  cmd.AddValue ("cachePropagation", "Compute the propagation loss and delay of each node pair once instead of for every frame", cachePropagation);
+  cmd.AddValue ("profile", "Print the wall time per phase, event counts and process peak RSS to standard error", profile);
+  cmd.AddValue ("profileFile", "if set, append the profile of the run to this file as a JSON line", profileFile);
   cmd.Parse (argc, argv);
+
+  if (!printTrace.empty ())
+    {
+      return PrintRxTrace (printTrace);
+    }
+
+  // Perfil de execução: fases de montagem, simulação, destruição e extração dos resultados
+  bool profiling = profile || !profileFile.empty ();
+  std::ostringstream profileLabel;
+  profileLabel << "run=" << RngSeedManager::GetRun ();
+  if (profiling)
+    {
+      RunProfiler::Enable ();
+    }
+  RunProfiler profiler (profileLabel.str ());
+  if (profiling)
+    {
+      profiler.StartPhase ("setup");
+    }
   // Converte o intervalo de envio do pacote para segundos
   Time interPacketInterval = Seconds (interval);
 
@@ -156,17 +933,18 @@ int main (int argc, char *argv[])
   wifiPhy.Set ("RxGain", DoubleValue (0) );
   wifiPhy.Set ("CcaMode1Threshold", DoubleValue (0.0) );
 
-  // ns-3 supports RadioTap and Prism tracing extensions for 802.11b
-  // DLT_IEEE802_11_RADIO inclui informações dos frames capturados: Radiotap link layer
-  wifiPhy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11_RADIO);
-
   // Definição da Velocidade de Propagação e Perda na Propagação
   // ConstantSpeedPropagationDelayModel: a velocidade é constante
   // LogDistancePropagationLossModel: modelo de perda de propagação baseado na distância
   YansWifiChannelHelper wifiChannel;
   wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
   wifiChannel.AddPropagationLoss ("ns3::LogDistancePropagationLossModel");
-  wifiPhy.SetChannel (wifiChannel.Create ());
+  Ptr<YansWifiChannel> channel = wifiChannel.Create ();
+  if (cachePropagation)
+    {
+      EnablePropagationCache (channel);
+    }
+  wifiPhy.SetChannel (channel);
 
   // Add a mac and disable rate control
   // ConstantRateWifiManager: utiliza taxa constante para transmissão de dados
@@ -184,6 +962,27 @@ int main (int argc, char *argv[])
   wifiPhy.Set ("TxGain", DoubleValue (offset + Irss) );
   devices.Add (wifi.Install (wifiPhy, wifiMac, c.Get (2)));
 
+  // Nós capturados, validados antes de iniciar as threads de gravação
+  std::vector<uint32_t> capturedNodes;
+  if (pcap)
+    {
+      std::istringstream nodes (pcapNodes);
+      std::string node;
+      while (std::getline (nodes, node, ','))
+        {
+          uint32_t n = std::atoi (node.c_str ());
+          if (n >= devices.GetN ())
+            {
+              NS_LOG_UNCOND ("Invalid pcap node " << node);
+              return 1;
+            }
+          if (std::find (capturedNodes.begin (), capturedNodes.end (), n) == capturedNodes.end ())
+            {
+              capturedNodes.push_back (n);
+            }
+        }
+    }
+
   // Note that with FixedRssLossModel, the positions below are not
   // used for received signal strength.
   MobilityHelper mobility;
@@ -203,7 +1002,14 @@ int main (int argc, char *argv[])
   Ptr<Socket> recvSink = Socket::CreateSocket (c.Get (0), tid);
   InetSocketAddress local = InetSocketAddress (Ipv4Address ("10.1.1.1"), 80);
   recvSink->Bind (local);
-  recvSink->SetRecvCallback (MakeCallback (&ReceivePacket));
+  RxSocketCounters recvCounters;
+  recvCounters.node = c.Get (0)->GetId ();
+  recvCounters.address = local.GetIpv4 ();
+  recvCounters.port = local.GetPort ();
+  recvCounters.packets = 0;
+  recvCounters.bytes = 0;
+  RxTraceRing *ring = traceFile.empty () ? 0 : new RxTraceRing (traceFile, traceRingSize);
+  recvSink->SetRecvCallback (MakeBoundCallback (&ReceivePacket, &recvCounters, ring));
 
   Ptr<Socket> source = Socket::CreateSocket (c.Get (1), tid);
   InetSocketAddress remote = InetSocketAddress (Ipv4Address ("255.255.255.255"), 80);
@@ -216,25 +1022,177 @@ int main (int argc, char *argv[])
   interferer->SetAllowBroadcast (true);
   interferer->Connect (interferingAddr);
 
-  // Tracing
-  wifiPhy.EnablePcap ("wifi-simple-interference", devices.Get (0));
+  // Tracing: captura pcap com cabeçalho Radiotap (DLT_IEEE802_11_RADIO) dos quadros
+  // transmitidos e recebidos por cada nó selecionado, em arquivos próprios do nó,
+  // nomeados pelo número da execução e pelo nó
+  std::vector<PcapFilter> pcapFilters (capturedNodes.size ());
+  for (uint32_t i = 0; i < capturedNodes.size (); i++)
+    {
+      std::ostringstream prefix;
+      prefix << pcapPrefix << "-" << RngSeedManager::GetRun () << "-" << capturedNodes[i];
+      pcapFilters[i].writer = new PcapRingWriter (prefix.str (), pcapBlockSize, pcapBlocks,
+                                                  static_cast<uint64_t> (pcapMaxFileSize * 1000000), pcapMaxFiles);
+      pcapFilters[i].port = pcapPort;
+      Ptr<WifiPhy> phy = DynamicCast<WifiNetDevice> (devices.Get (capturedNodes[i]))->GetPhy ();
+      phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeBoundCallback (&PcapSniffRx, &pcapFilters[i]));
+      phy->TraceConnectWithoutContext ("MonitorSnifferTx", MakeBoundCallback (&PcapSniffTx, &pcapFilters[i]));
+    }
+
+  // Varredura: todos os pontos da grade em uma única simulação
+  bool sweepMode = !PrssRange.empty () || !IrssRange.empty () || !deltaRange.empty ()
+    || !PpacketSizeRange.empty () || !IpacketSizeRange.empty ();
+  if (sweepMode)
+    {
+      InterferenceSweep sweep;
+      std::vector<double> prssValues = ParseRange (PrssRange, Prss);
+      std::vector<double> irssValues = ParseRange (IrssRange, Irss);
+      std::vector<double> deltaValues = ParseRange (deltaRange, delta);
+      std::vector<double> pSizeValues = ParseRange (PpacketSizeRange, PpacketSize);
+      std::vector<double> iSizeValues = ParseRange (IpacketSizeRange, IpacketSize);
+      double maxDelta = 0;
+      uint32_t maxPSize = 0;
+      uint32_t maxISize = 0;
+      // Percorre a grade com o tamanho do pacote interferente variando mais rápido
+      uint32_t nPoints = prssValues.size () * irssValues.size () * deltaValues.size ()
+        * pSizeValues.size () * iSizeValues.size ();
+      for (uint32_t i = 0; i < nPoints; i++)
+        {
+          uint32_t k = i;
+          InterferencePoint point;
+          point.IpacketSize = static_cast<uint32_t> (iSizeValues[k % iSizeValues.size ()]);
+          k /= iSizeValues.size ();
+          point.PpacketSize = static_cast<uint32_t> (pSizeValues[k % pSizeValues.size ()]);
+          k /= pSizeValues.size ();
+          point.delta = deltaValues[k % deltaValues.size ()];
+          k /= deltaValues.size ();
+          point.Irss = irssValues[k % irssValues.size ()];
+          k /= irssValues.size ();
+          point.Prss = prssValues[k];
+          sweep.points.push_back (point);
+          maxDelta = std::max (maxDelta, std::abs (point.delta));
+          maxPSize = std::max (maxPSize, point.PpacketSize);
+          maxISize = std::max (maxISize, point.IpacketSize);
+        }
+      // O pacote primário é enviado a um quarto do intervalo, de modo que atrasos
+      // negativos caibam no mesmo intervalo
+      if (trials == 0 || maxDelta / 1000000.0 >= slotTime / 4)
+        {
+          NS_LOG_UNCOND ("trials must be positive and |delta| smaller than slotTime / 4");
+          delete ring;
+          DeletePcapWriters (pcapFilters);
+          return 1;
+        }
+      // Os dois quadros da tentativa devem terminar dentro do intervalo: o maior quadro de
+      // cada fonte, com o DIFS de acesso ao meio e, para o interferente, o maior atraso.
+      // Cada quadro leva os cabeçalhos UDP, IPv4, LLC/SNAP e MAC e o FCS.
+      Ptr<WifiPhy> phy = DynamicCast<WifiNetDevice> (devices.Get (1))->GetPhy ();
+      WifiTxVector txVector;
+      txVector.SetMode (WifiMode (phyMode));
+      txVector.SetPreambleType (WIFI_PREAMBLE_LONG);
+      txVector.SetChannelWidth (phy->GetChannelWidth ());
+      uint32_t overhead = 8 + 20 + 8 + 24 + 4;
+      Time difs = phy->GetSifs () + 2 * phy->GetSlot ();
+      Time primaryEnd = Seconds (slotTime / 4) + difs
+        + WifiPhy::CalculateTxDuration (maxPSize + overhead, txVector, phy->GetFrequency ());
+      Time interfererEnd = Seconds (slotTime / 4) + MicroSeconds (maxDelta) + difs
+        + WifiPhy::CalculateTxDuration (maxISize + overhead, txVector, phy->GetFrequency ());
+      if (std::max (primaryEnd, interfererEnd) >= Seconds (slotTime))
+        {
+          NS_LOG_UNCOND ("slotTime must exceed slotTime / 4 + |delta| + the longest frame ("
+                         << std::max (primaryEnd, interfererEnd).GetSeconds () << " s at " << phyMode << ")");
+          delete ring;
+          DeletePcapWriters (pcapFilters);
+          return 1;
+        }
+      sweep.trials = trials;
+      sweep.start = Seconds (slotTime);
+      sweep.slotTime = Seconds (slotTime);
+      sweep.sendOffset = Seconds (slotTime / 4);
+      sweep.offset = offset;
+      sweep.primaryPhy = DynamicCast<WifiNetDevice> (devices.Get (1))->GetPhy ();
+      sweep.interfererPhy = DynamicCast<WifiNetDevice> (devices.Get (2))->GetPhy ();
+      sweep.source = source;
+      sweep.interferer = interferer;
+      sweep.counters = &recvCounters;
+      sweep.ring = ring;
+      sweep.received.assign (sweep.points.size () * trials, 0);
+      recvSink->SetRecvCallback (MakeBoundCallback (&ReceiveTrialPacket, &sweep));
+
+      NS_LOG_UNCOND ("Sweeping " << sweep.points.size () << " points with " << trials << " trials each");
+      Simulator::Schedule (sweep.start, &StartTrial, &sweep, 0);
+      if (profiling)
+        {
+          profiler.StartPhase ("run");
+        }
+      Simulator::Run ();
+      if (profiling)
+        {
+          profiler.StartPhase ("destroy");
+        }
+      Simulator::Destroy ();
+      if (profiling)
+        {
+          profiler.StartPhase ("extract");
+        }
+      WriteSweepResults (sweep, sweepFile);
+      NS_LOG_UNCOND ("Received " << recvCounters.packets << " packet(s), " << recvCounters.bytes << " bytes  Socket: "
+                     << recvCounters.address << " port: " << recvCounters.port);
+      if (ring != 0)
+        {
+          ring->Stop ();
+          NS_LOG_UNCOND ("Receive trace written to " << traceFile << " (" << ring->GetStalls () << " stalls on a full ring)");
+          delete ring;
+        }
+      DeletePcapWriters (pcapFilters);
+      if (profiling)
+        {
+          profiler.Stop ();
+          profiler.Report (profile, profileFile);
+        }
+      return 0;
+    }
 
   // Output what we are doing
   // Retorna as informações com NS_LOG_UNCOND: PRSS, IRSS e DELTA
   NS_LOG_UNCOND ("Primary packet RSS=" << Prss << " dBm and interferer RSS=" << Irss << " dBm at time offset=" << delta << " ms");
 
   // Schedula a simulação com os parâmetros pertinentes ao transmissor
-  Simulator::ScheduleWithContext (source->GetNode ()->GetId (),
-                                  Seconds (startTime), &GenerateTraffic,
-                                  source, PpacketSize, numPackets, interPacketInterval);
+  TrafficSource primarySource (source, PpacketSize, numPackets, interPacketInterval, burst);
+  primarySource.Start (Seconds (startTime));
 
   // Schedula a simulação com os parâmetros pertinentes à fonte de interferência
-  Simulator::ScheduleWithContext (interferer->GetNode ()->GetId (),
-                                  Seconds (startTime + delta / 1000000.0), &GenerateTraffic,
-                                  interferer, IpacketSize, numPackets, interPacketInterval);
+  TrafficSource interferingSource (interferer, IpacketSize, numPackets, interPacketInterval, burst);
+  interferingSource.Start (Seconds (startTime + delta / 1000000.0));
 
+  if (profiling)
+    {
+      profiler.StartPhase ("run");
+    }
   Simulator::Run (); // Roda a simulação até que um comando de STOP seja invocado
+  if (profiling)
+    {
+      profiler.StartPhase ("destroy");
+    }
   Simulator::Destroy ();
+  if (profiling)
+    {
+      profiler.StartPhase ("extract");
+    }
+
+  NS_LOG_UNCOND ("Received " << recvCounters.packets << " packet(s), " << recvCounters.bytes << " bytes  Socket: "
+                 << recvCounters.address << " port: " << recvCounters.port);
+  if (ring != 0)
+    {
+      ring->Stop ();
+      NS_LOG_UNCOND ("Receive trace written to " << traceFile << " (" << ring->GetStalls () << " stalls on a full ring)");
+      delete ring;
+    }
+  DeletePcapWriters (pcapFilters);
+  if (profiling)
+    {
+      profiler.Stop ();
+      profiler.Report (profile, profileFile);
+    }
 
   return 0;
 }